@@ -0,0 +1,29 @@
+#!/bin/sh
+# time random walks through choice trees of increasing depth:
+#    choice-tree.sh [steps]
+# the output is given as CSV
+
+steps=${1:-20000}
+dir=$(dirname "$0")
+trace="$dir/../csp/trace"
+if [ ! -x "$trace" ]; then
+   echo "$0: $trace not found, please build it first" >&2
+   exit 1
+fi
+tmp=${TMPDIR:-/tmp}/choice-tree.$$.csp
+trap 'rm -f "$tmp"' 0
+
+echo "operator,depth,steps,seconds,steps_per_second"
+for op in "[]" "|~|"; do
+   for depth in 1 2 4 8 16 32 64; do
+      sh "$dir/gen-choice-tree.sh" $depth "$op" >"$tmp"
+      start=$(date +%s.%N)
+      "$trace" -apv -P $steps "$tmp" >/dev/null
+      end=$(date +%s.%N)
+      echo "$op $depth $steps $start $end" | awk '{
+	 secs = $5 - $4
+	 printf "\"%s\",%d,%d,%.3f,%.0f\n", $1, $2, $3, secs,
+	    (secs > 0? $3 / secs: 0)
+      }'
+   done
+done
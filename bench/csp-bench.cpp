@@ -0,0 +1,180 @@
+/* 
+   Copyright (c) 2011-2024 Andreas F. Borchert
+   All rights reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining
+   a copy of this software and associated documentation files (the
+   "Software"), to deal in the Software without restriction, including
+   without limitation the rights to use, copy, modify, merge, publish,
+   distribute, sublicense, and/or sell copies of the Software, and to
+   permit persons to whom the Software is furnished to do so, subject to
+   the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+   KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+   BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+*/
+
+/*
+   benchmark harness which times for each of the given models
+    - parsing (including scanning),
+    - the inference of the alphabets, and
+    - a random walk of up to n steps,
+   and prints the results as CSV, one line per model
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <tuple>
+
+#include "context.hpp"
+#include "parser.hpp"
+#include "process.hpp"
+#include "scanner.hpp"
+#include "status.hpp"
+#include "symtable.hpp"
+
+using namespace CSP;
+
+void usage(const char* cmdname) {
+   std::cerr << "Usage: " << cmdname <<
+      " [-H] [-P steps] [-S seed] [-T seconds] model.csp..." << std::endl;
+   std::cerr << "Options:" << std::endl;
+   std::cerr << " -H         do not print the CSV header" << std::endl;
+   std::cerr << " -P steps   maximal length of the random walk " <<
+      "(default 100000)" << std::endl;
+   std::cerr << " -S seed    seed for the pseudo random generator " <<
+      "(default 4711)" << std::endl;
+   std::cerr << " -T seconds stop the random walk after the given time" <<
+      std::endl;
+   std::exit(1);
+}
+
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point start) {
+   return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/* returns false if the model cannot be parsed */
+bool run(const char* fname, std::uint64_t max_steps, std::uint64_t seed,
+      double max_time) {
+   std::ifstream fin(fname, std::ios::binary | std::ios::ate);
+   if (!fin) {
+      std::cerr << "unable to open " << fname << " for reading" <<
+	 std::endl;
+      return false;
+   }
+   std::streamoff bytes = fin.tellg();
+   fin.seekg(0);
+
+   auto start = Clock::now();
+   std::string filename(fname);
+   Context context;
+   Scanner scanner(context, fin, filename);
+   SymTable symtab(context);
+   ProcessPtr process;
+   parser p(context, process);
+   if (p.parse() != 0 || context.get_error_count() > 0) return false;
+   double parse_time = seconds_since(start);
+
+   start = Clock::now();
+   auto alphabet_size = process->get_alphabet().cardinality();
+   double alphabet_time = seconds_since(start);
+
+   /* like trace -P, the walk ends earlier in case of a deadlock
+      or a successful termination; large models may be
+      limited by time instead of steps */
+   start = Clock::now();
+   auto status = std::make_shared<Status>(seed);
+   std::uint64_t steps = 0;
+   std::string event;
+   while (steps < max_steps && !process->accepts_success(status)) {
+      if (max_time > 0 && seconds_since(start) >= max_time) break;
+      auto acceptable = process->acceptable(status);
+      if (acceptable.cardinality() == 0) break;
+      auto chose = status->draw(acceptable.cardinality());
+      event = *std::next(acceptable.begin(), chose);
+      std::tie(process, status) = process->proceed(event, status);
+      if (!process) {
+	 std::cerr << fname << ": acceptable event " << event <<
+	    " refused" << std::endl;
+	 return false;
+      }
+      ++steps;
+   }
+   double walk_time = seconds_since(start);
+
+   std::cout << fname << "," << bytes << "," <<
+      parse_time << "," << alphabet_time << "," << alphabet_size << "," <<
+      steps << "," << walk_time << "," <<
+      (walk_time > 0? steps / walk_time: 0) << std::endl;
+   return true;
+}
+
+int main(int argc, char** argv) {
+   const char* cmdname = *argv++; --argc;
+   bool opt_H = false; // suppress header
+   std::uint64_t max_steps = 100000; // parameter of -P
+   std::uint64_t seed = 4711; // parameter of -S
+   double max_time = 0; // parameter of -T, 0 if not given
+   /* fetch numerical argument of an option */
+   auto get_arg = [&](char*& cp) -> std::uint64_t {
+      char* arg = cp+1;
+      if (!*arg) {
+	 --argc; ++argv;
+	 if (argc == 0) usage(cmdname);
+	 arg = *argv;
+      }
+      char* endptr;
+      auto value = std::strtoull(arg, &endptr, 10);
+      if (endptr == arg || *endptr) usage(cmdname);
+      cp = endptr-1;
+      return value;
+   };
+   while (argc > 0 && **argv == '-') {
+      for (char* cp = *argv + 1; *cp; ++cp) {
+	 switch (*cp) {
+	    case 'H':
+	       opt_H = true; break;
+	    case 'P':
+	       max_steps = get_arg(cp); break;
+	    case 'S':
+	       seed = get_arg(cp); break;
+	    case 'T':
+	       max_time = get_arg(cp);
+	       if (max_time == 0) usage(cmdname);
+	       break;
+	    default:
+	       usage(cmdname); break;
+	 }
+      }
+      --argc; ++argv;
+   }
+   if (argc == 0) usage(cmdname);
+
+   if (!opt_H) {
+      std::cout << "model,bytes,parse_seconds,alphabet_seconds," <<
+	 "alphabet_size,steps,walk_seconds,steps_per_second" << std::endl;
+   }
+   bool ok = true;
+   while (argc > 0) {
+      if (!run(*argv, max_steps, seed, max_time)) ok = false;
+      --argc; ++argv;
+   }
+   return ok? 0: 1;
+}
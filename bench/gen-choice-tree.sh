@@ -0,0 +1,22 @@
+#!/bin/sh
+# generate a process with a deep choice tree:
+#    gen-choice-tree.sh depth [operator]
+# where operator is either "[]" (default) or "|~|"
+# the choices are nested to the right, i.e. for depth 3 we get
+#    P = (e1 -> P) [] ((e2 -> P) [] (e3 -> P))
+
+if [ $# -lt 1 -o $# -gt 2 ]; then
+   echo "Usage: $0 depth [operator]" >&2
+   exit 1
+fi
+depth=$1
+op=${2:-"[]"}
+
+awk -v depth="$depth" -v op="$op" 'BEGIN {
+   printf "-- choice tree of depth %d using %s\n", depth, op
+   tree = "(e" depth " -> P)"
+   for (i = depth - 1; i >= 1; --i) {
+      tree = "(e" i " -> P) " op " (" tree ")"
+   }
+   print "P = " tree
+}'
@@ -0,0 +1,34 @@
+#!/bin/sh
+# generate the dining philosophers of CSP 2.5 for n philosophers:
+#    gen-philosophers.sh n
+# the last philosopher picks up the forks in reverse order
+# which avoids the deadlock without a footman
+
+if [ $# -ne 1 ]; then
+   echo "Usage: $0 n" >&2
+   exit 1
+fi
+
+awk -v n="$1" 'BEGIN {
+   printf "-- dining philosophers with %d philosophers\n", n
+   college = "PHIL0"
+   for (i = 1; i < n; ++i) college = college " || PHIL" i
+   for (i = 0; i < n; ++i) college = college " || FORK" i
+   print college
+   for (i = 0; i < n; ++i) {
+      left = i; right = (i + 1) % n
+      first = left; second = right
+      if (i == n - 1) { first = right; second = left }
+      printf "PHIL%d = (p%d.sits -> p%d.up.f%d -> p%d.up.f%d ->\n", \
+	 i, i, i, first, i, second
+      printf "   p%d.down.f%d -> p%d.down.f%d -> p%d.gets.up -> PHIL%d)\n", \
+	 i, first, i, second, i, i
+   }
+   for (i = 0; i < n; ++i) {
+      prev = (i + n - 1) % n
+      printf "FORK%d = (p%d.up.f%d -> p%d.down.f%d -> FORK%d |\n", \
+	 i, i, i, i, i, i
+      printf "   p%d.up.f%d -> p%d.down.f%d -> FORK%d)\n", \
+	 prev, i, prev, i, i
+   }
+}'
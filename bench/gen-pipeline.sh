@@ -0,0 +1,19 @@
+#!/bin/sh
+# generate a pipeline of n one-place buffers:
+#    gen-pipeline.sh n
+# the messages are restricted to 0 and 1 such that random walks
+# never need to pick from an infinite alphabet
+
+if [ $# -ne 1 ]; then
+   echo "Usage: $0 n" >&2
+   exit 1
+fi
+
+awk -v n="$1" 'BEGIN {
+   printf "-- pipeline of %d buffers\n", n
+   pipeline = "COPY"
+   for (i = 1; i < n; ++i) pipeline = pipeline " >> COPY"
+   print pipeline
+   print "COPY = (left?x -> right!x -> COPY)"
+   print "alpha left(COPY) = alpha right(COPY) = {0, 1}"
+}'
@@ -0,0 +1,21 @@
+#!/bin/sh
+# generate a ring of n nodes that pass a token around:
+#    gen-token-ring.sh n
+# node i works only while it holds the token, node 0 starts with it
+
+if [ $# -ne 1 ]; then
+   echo "Usage: $0 n" >&2
+   exit 1
+fi
+
+awk -v n="$1" 'BEGIN {
+   printf "-- token ring with %d nodes\n", n
+   ring = "NODE0"
+   for (i = 1; i < n; ++i) ring = ring " || NODE" i
+   print ring
+   printf "NODE0 = (work0 -> tok%d -> tok0 -> NODE0)\n", 1 % n
+   for (i = 1; i < n; ++i) {
+      printf "NODE%d = (tok%d -> work%d -> tok%d -> NODE%d)\n", \
+	 i, i, i, (i + 1) % n, i
+   }
+}'
@@ -0,0 +1,17 @@
+#!/bin/sh
+# generate n labeled vending machines of CSP 1.1.3 that run in parallel
+# (see CSP 2.6.2):
+#    gen-vending.sh n
+
+if [ $# -ne 1 ]; then
+   echo "Usage: $0 n" >&2
+   exit 1
+fi
+
+awk -v n="$1" 'BEGIN {
+   printf "-- %d vending machines\n", n
+   machines = "(v0:VMCT)"
+   for (i = 1; i < n; ++i) machines = machines " || (v" i ":VMCT)"
+   print machines
+   print "VMCT = (coin -> (choc -> VMCT | toffee -> VMCT))"
+}'
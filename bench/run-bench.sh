@@ -0,0 +1,27 @@
+#!/bin/sh
+# run csp-bench on generated models of increasing sizes:
+#    run-bench.sh [steps [seconds]]
+# where each random walk is limited by the given number of steps
+# and seconds; the output is given as CSV on standard output
+
+steps=${1:-100000}
+seconds=${2:-2}
+dir=$(cd "$(dirname "$0")" && pwd)
+bench="$dir/csp-bench"
+if [ ! -x "$bench" ]; then
+   echo "$0: $bench not found, please build it first" >&2
+   exit 1
+fi
+tmp=${TMPDIR:-/tmp}/csp-bench.$$
+trap 'rm -rf "$tmp"' 0
+mkdir "$tmp" || exit 1
+
+models=""
+for model in philosophers token-ring vending choice-tree pipeline; do
+   for n in 4 16 64; do
+      sh "$dir/gen-$model.sh" $n >"$tmp/$model-$n.csp"
+      models="$models $model-$n.csp"
+   done
+done
+
+cd "$tmp" && "$bench" -P $steps -T $seconds $models
@@ -27,53 +27,85 @@
 #define CSP_ALPHABET_HPP
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cctype>
+#include <cstddef>
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <set>
 #include <string>
+#include <string_view>
+#include <utility>
+
+#include "memory-accounting.hpp"
 
 namespace CSP {
 
    class Alphabet {
       public:
-	 using Set = std::set<std::string>;
+	 /* std::less<> permits lookups by string views */
+	 using Set = std::set<std::string, std::less<>,
+	    AccountingAllocator<std::string,
+	       MemoryAccounting::alphabet_entries>>;
 	 using Iterator = Set::const_iterator;
 
-	 Alphabet() {
+	 Alphabet() : events(empty_set()) {
+	 }
+
+	 Alphabet(const std::string& event) :
+	       events(make_set(Set{event})),
+	       patterns(is_pattern(event)) {
 	 }
 
-	 Alphabet(const std::string& event) : events{event} {
+	 Alphabet(const Set& set) : events(make_set(set)) {
+	    count_patterns();
 	 }
 
-	 Alphabet(const Set& set) : events(set) {
+	 Alphabet(Set&& set) : events(make_set(std::move(set))) {
+	    count_patterns();
 	 }
 
+	 /* no move operations as moved-from alphabets
+	    would be left without a set */
+	 Alphabet(const Alphabet& other) = default;
+	 Alphabet& operator=(const Alphabet& other) = default;
+
 	 void add(const std::string& event) {
 	    if (!is_member(event)) {
-	       events.insert(event);
+	       modifiable_events().insert(event);
+	       patterns += is_pattern(event);
 	    }
 	 }
 
 	 Iterator begin() const {
-	    return events.begin();
+	    return events->begin();
 	 }
 
 	 Iterator end() const {
-	    return events.end();
+	    return events->end();
 	 }
 
-	 bool is_member(const std::string& event) const {
-	    return matches(events, event);
+	 bool is_member(std::string_view event) const {
+	    return matches(*events, event);
 	 }
 
 	 int cardinality() const {
-	    return events.size();
+	    return events->size();
 	 }
 
 	 bool operator>=(const Alphabet& other) const {
-	    return std::includes(events.begin(), events.end(),
-	       other.events.begin(), other.events.end());
+	    if (events == other.events) return true;
+	    if (other.cardinality() > cardinality()) return false;
+	    /* lookups are cheaper for small subsets */
+	    if (other.cardinality() < cardinality() / 16) {
+	       return std::all_of(other.begin(), other.end(),
+		  [this](const std::string& event) {
+		     return events->find(event) != events->end();
+		  });
+	    }
+	    return std::includes(begin(), end(), other.begin(), other.end());
 	 }
 
 	 bool operator<=(const Alphabet& other) const {
@@ -81,9 +113,9 @@ namespace CSP {
 	 }
 
 	 bool operator==(const Alphabet& other) const {
+	    if (events == other.events) return true;
 	    return cardinality() == other.cardinality() &&
-	       std::equal(events.begin(), events.end(),
-		  other.events.begin());
+	       std::equal(begin(), end(), other.begin());
 	 }
 
 	 bool operator!=(const Alphabet& other) const {
@@ -91,7 +123,7 @@ namespace CSP {
 	 }
 
 	 operator bool() const {
-	    return events.size() > 0;
+	    return events->size() > 0;
 	 }
 
 	 /* inclusion */
@@ -100,43 +132,59 @@ namespace CSP {
 	    return *this;
 	 }
 	 Alphabet& operator+=(const Alphabet& a) {
-	    events.insert(a.begin(), a.end());
+	    if (a.events != events) {
+	       auto& set = modifiable_events();
+	       for (auto& event: a) {
+		  if (set.insert(event).second) {
+		     patterns += is_pattern(event);
+		  }
+	       }
+	    }
 	    return *this;
 	 }
 
+	 /* *this = *this + other but in place if possible */
+	 void unite(const Alphabet& other) {
+	    if (patterns == 0 && other.patterns == 0) {
+	       /* the union is trivial without patterns */
+	       *this += other;
+	    } else {
+	       *this = *this + other;
+	    }
+	 }
+
 	 /* union */
 	 Alphabet operator+(const Alphabet& other) const {
 	    Set result; Set delayed;
-	    for (auto event: events) {
+	    for (auto& event: *events) {
 	       if (other.is_member(event)) {
 		  delayed.insert(event);
 	       } else {
 		  result.insert(event);
 	       }
 	    }
-	    for (auto event: other.events) {
+	    for (auto& event: *other.events) {
 	       if (is_member(event)) {
 		  delayed.insert(event);
 	       } else {
 		  result.insert(event);
 	       }
 	    }
-	    for (auto event: delayed) {
+	    for (auto& event: delayed) {
 	       if (!matches(result, event)) {
 		  result.insert(event);
 	       }
 	    }
-	    return Alphabet(result);
+	    return Alphabet(std::move(result));
 	 }
 
 	 /* difference */
 	 Alphabet operator-(const Alphabet& other) const {
 	    Set result;
 	    auto inserter = std::inserter(result, result.end());
-	    std::set_difference(events.begin(), events.end(),
-	       other.events.begin(), other.events.end(),
+	    std::set_difference(begin(), end(), other.begin(), other.end(),
 	       inserter);
-	    return Alphabet(result);
+	    return Alphabet(std::move(result));
 	 }
 
 	 /* intersection */
@@ -145,37 +193,84 @@ namespace CSP {
 	    /* this cannot be done through std::set_intersection
 	       in cases where we operate with integers or strings
 	       as alphabets */
-	    for (auto event: events) {
+	    for (auto& event: *events) {
 	       if (other.is_member(event)) {
 		  result.insert(event);
 	       }
 	    }
-	    for (auto event: other.events) {
+	    for (auto& event: *other.events) {
 	       if (is_member(event)) {
 		  result.insert(event);
 	       }
 	    }
-	    return Alphabet(result);
+	    return Alphabet(std::move(result));
 	 }
 
 	 /* symmetric difference */
 	 Alphabet operator/(const Alphabet& other) const {
 	    Set result;
 	    auto inserter = std::inserter(result, result.end());
-	    std::set_symmetric_difference(events.begin(), events.end(),
-	       other.events.begin(), other.events.end(),
-	       inserter);
-	    return Alphabet(result);
+	    std::set_symmetric_difference(begin(), end(),
+	       other.begin(), other.end(), inserter);
+	    return Alphabet(std::move(result));
 	 }
       private:
-	 Set events;
+	 /* the set of events is shared among copies of an alphabet
+	    until one of them is modified (copy on write); hence
+	    alphabets may be copied in O(1) */
+	 std::shared_ptr<Set> events;
+	 /* number of events which match other events,
+	    i.e. events ending in "*integer*" or "*string*" */
+	 std::size_t patterns = 0;
+
+	 static bool is_pattern(std::string_view event) {
+	    auto ends_with = [event](std::string_view suffix) {
+	       return event.size() >= suffix.size() &&
+		  event.substr(event.size() - suffix.size()) == suffix;
+	    };
+	    return ends_with("*integer*") || ends_with("*string*");
+	 }
+	 void count_patterns() {
+	    for (auto& event: *events) {
+	       patterns += is_pattern(event);
+	    }
+	 }
+
+	 static const std::shared_ptr<Set>& empty_set() {
+	    static const std::shared_ptr<Set> empty = make_set();
+	    return empty;
+	 }
 
-	 bool matches(const Set& events, const std::string& event) const {
+	 template<typename... Args>
+	 static std::shared_ptr<Set> make_set(Args&&... args) {
+	    using Allocator = AccountingAllocator<Set,
+	       MemoryAccounting::alphabet_sets>;
+	    return std::allocate_shared<Set>(Allocator(),
+	       std::forward<Args>(args)...);
+	 }
+
+	 /* copies of an alphabet share their set, possibly among
+	    threads, and a set is changed in place only if no other
+	    copy refers to it; an alphabet itself must not be changed
+	    while other threads access it, as the alphabets of
+	    processes after they have been shared. The fence orders
+	    the accesses of copies dropped by other threads before
+	    our changes as use_count() is a relaxed load */
+	 Set& modifiable_events() {
+	    if (events.use_count() != 1) {
+	       events = make_set(*events);
+	    } else {
+	       std::atomic_thread_fence(std::memory_order_acquire);
+	    }
+	    return *events;
+	 }
+
+	 bool matches(const Set& events, std::string_view event) const {
 	    auto it = events.find(event);
 	    if (it != events.end()) return true;
 
 	    if (event.size() <= 2) return false;
-	    const char* s = event.c_str();
+	    const char* s = event.data();
 	    const char* cp = s + event.size() - 2;
 	    bool is_string = false; bool is_numeric = false;
 	    if (cp[1] == '"') is_string = true;
@@ -188,7 +283,7 @@ namespace CSP {
 	    if (cp == s) return false;
 	    if (is_string && cp[1] != '"') return false;
 
-	    std::string key = event.substr(0, cp - s + 1);
+	    std::string key(event.substr(0, cp - s + 1));
 	    if (is_string) {
 	       key += "*string*";
 	    } else if (is_numeric) {
@@ -201,20 +296,17 @@ namespace CSP {
 	 }
    };
 
+   /* returns true if event is of the form "prefix.x" */
    inline bool matches_prefix(const std::string& event,
 	 const std::string& prefix) {
       auto prefix_len = prefix.size();
-      auto event_len = event.size();
-      if (event_len <= prefix_len + 2) return false;
-      if (event.substr(0, prefix_len) == prefix &&
-	    event[prefix_len] == '.') {
-	 return true;
-      }
-      return false;
+      return event.size() > prefix_len + 1 &&
+	 event.compare(0, prefix_len, prefix) == 0 &&
+	 event[prefix_len] == '.';
    }
 
    inline Alphabet exclude_prefix(const Alphabet& alphabet,
-	 std::string prefix) {
+	 const std::string& prefix) {
       Alphabet result;
       for (auto& event: alphabet) {
 	 if (!matches_prefix(event, prefix)) {
@@ -224,7 +316,8 @@ namespace CSP {
       return result;
    }
 
-   inline Alphabet select_prefix(const Alphabet& alphabet, std::string prefix) {
+   inline Alphabet select_prefix(const Alphabet& alphabet,
+	 const std::string& prefix) {
       Alphabet result;
       for (auto& event: alphabet) {
 	 if (matches_prefix(event, prefix)) {
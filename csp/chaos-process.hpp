@@ -49,7 +49,7 @@ namespace CSP {
 	 void print(std::ostream& out) const override {
 	    out << "CHAOS " << get_alphabet();
 	 }
-	 Alphabet acceptable(StatusPtr status) const final {
+	 Alphabet internal_acceptable(StatusPtr status) const final {
 	    auto s = get_status<InternalStatus>(status);
 	    decide(s);
 	    return s->accepting_next;
@@ -63,6 +63,9 @@ namespace CSP {
 	    InternalStatus(StatusPtr status) :
 	       Status(status), state(undecided) {
 	    }
+	    StatusPtr copy() const override {
+	       return make_accounted<InternalStatus>(*this);
+	    }
 	 };
 	 using InternalStatusPtr = std::shared_ptr<InternalStatus>;
 
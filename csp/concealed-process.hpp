@@ -38,6 +38,7 @@
 #include <tuple>
 
 #include "alphabet.hpp"
+#include "instrumentation.hpp"
 #include "process.hpp"
 #include "uniformint.hpp"
 
@@ -51,9 +52,9 @@ namespace CSP {
 	    assert(concealed.cardinality() > 0); // otherwise not useful
 	 }
 	 void print(std::ostream& out) const override {
-	    process->print(out); out << " \\ " << concealed;
+	    print_subterm(out, process); out << " \\ " << concealed;
 	 }
-	 Alphabet acceptable(StatusPtr status) const final {
+	 Alphabet internal_acceptable(StatusPtr status) const final {
 	    auto s = get_status<InternalStatus>(status);
 	    decide(s);
 	    if (s->next) {
@@ -74,8 +75,18 @@ namespace CSP {
 	    enum {undecided, decided} state;
 	    ProcessPtr next; // defined if state == decided
 
+	    /* process gets a status of its own as the given status
+	       refers to us as its extension which would form a cycle */
 	    InternalStatus(StatusPtr status) :
-	       Status(status), status(status), state(undecided) {
+	       Status(status), status(make_accounted<Status>(status)),
+	       state(undecided) {
+	    }
+	    StatusPtr copy() const override {
+	       return make_accounted<InternalStatus>(*this);
+	    }
+	    void clone_members(Cloner& clone) override {
+	       Status::clone_members(clone);
+	       status = clone(status);
 	    }
 	 };
 	 using InternalStatusPtr = std::shared_ptr<InternalStatus>;
@@ -89,7 +100,7 @@ namespace CSP {
 	       return {nullptr, s};
 	    }
 	    std::tie(p, s->status) = p->proceed(event, s->status);
-	    p = std::make_shared<ConcealedProcess>(p, concealed);
+	    p = make_accounted<ConcealedProcess>(p, concealed);
 	    p->set_alphabet(process->get_alphabet() - concealed);
 	    s->state = InternalStatus::undecided;
 	    return {p, s};
@@ -122,6 +133,9 @@ namespace CSP {
 		     s->next = p; s->state = InternalStatus::decided;
 		     return;
 		  }
+		  if (Instrumentation::enabled()) {
+		     Instrumentation::count_tau_step();
+		  }
 		  std::tie(p, s->status) = p->proceed(event, s->status);
 	       }
 	       /* emergency break from a possibly otherwise endless loop;
@@ -0,0 +1,248 @@
+/* 
+   Copyright (c) 2011-2024 Andreas F. Borchert
+   All rights reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining
+   a copy of this software and associated documentation files (the
+   "Software"), to deal in the Software without restriction, including
+   without limitation the rights to use, copy, modify, merge, publish,
+   distribute, sublicense, and/or sell copies of the Software, and to
+   permit persons to whom the Software is furnished to do so, subject to
+   the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+   KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+   BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+*/
+
+#ifndef CSP_COVERAGE_HPP
+#define CSP_COVERAGE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "location.hh"
+
+/*
+   optional coverage of a model by the runs of trace, see option
+   --coverage: coverage points are registered by the parser for
+   process definitions, the branches of choices, prefixes,
+   and input and output operations; a point is hit whenever
+   its process accepts an event; in addition, the messages of each
+   channel passed by input or output operations are collected;
+   counters are kept per thread and added to the global totals
+   when a thread terminates
+*/
+
+namespace CSP {
+
+   class Coverage {
+      public:
+	 using Point = std::size_t;
+	 static constexpr Point none = std::numeric_limits<Point>::max();
+
+	 enum Kind {definition, branch, prefix, communication, kinds};
+
+	 /* to be set before a model is parsed and
+	    not to be changed afterwards */
+	 static bool enabled() {
+	    return on;
+	 }
+	 static void enable() {
+	    global(); // constructed before any atexit handler
+	    on = true;
+	 }
+
+	 /* returns none if coverage is not enabled */
+	 static Point add(Kind kind, const location& loc,
+	       const std::string& label) {
+	    if (!on) return none;
+	    auto& g = global();
+	    std::lock_guard<std::mutex> lock(g.mutex);
+	    g.points.push_back({kind, loc.begin.line, loc.begin.column,
+	       label});
+	    return g.points.size() - 1;
+	 }
+	 static std::string get_label(Point point) {
+	    if (point == none) return "";
+	    auto& g = global();
+	    std::lock_guard<std::mutex> lock(g.mutex);
+	    return g.points[point].label;
+	 }
+
+	 /* record that the process of point accepted event */
+	 static void hit(Point point, const std::string& event) {
+	    auto& local = get_local();
+	    if (point >= local.hits.size()) {
+	       local.hits.resize(point + 1);
+	       local.kinds.resize(point + 1, kinds);
+	    }
+	    ++local.hits[point];
+	    if (local.kinds[point] == kinds) {
+	       auto& g = global();
+	       std::lock_guard<std::mutex> lock(g.mutex);
+	       local.kinds[point] = g.points[point].kind;
+	    }
+	    if (local.kinds[point] == communication) {
+	       local.messages.insert(event);
+	    }
+	 }
+
+	 /* the totals are complete once all threads have terminated;
+	    this includes the main thread if invoked by a handler
+	    registered with std::atexit */
+	 static void print_report(std::ostream& out,
+	       const std::string& filename) {
+	    auto& g = global();
+	    std::lock_guard<std::mutex> lock(g.mutex);
+	    static const char* names[] = {
+	       "definitions", "branches", "prefixes", "communications",
+	    };
+	    static const char* singular[] = {
+	       "definition", "branch", "prefix", "communication",
+	    };
+	    std::size_t total[kinds] = {};
+	    std::size_t covered[kinds] = {};
+	    for (Point point = 0; point < g.points.size(); ++point) {
+	       auto kind = g.points[point].kind;
+	       ++total[kind];
+	       if (hits(g, point) > 0) ++covered[kind];
+	    }
+	    out << "coverage of " << filename << ":" << std::endl;
+	    for (int kind = 0; kind < kinds; ++kind) {
+	       out << "   " << std::left << std::setw(16) << names[kind] <<
+		  std::right << std::setw(8) << covered[kind] << " of " <<
+		  std::setw(8) << total[kind];
+	       if (total[kind] > 0) {
+		  out << std::fixed << std::setprecision(1) << " (" <<
+		     100.0 * covered[kind] / total[kind] << "%)";
+	       }
+	       out << std::endl;
+	    }
+	    /* the events collected are of the form channel.message */
+	    std::map<std::string, std::size_t> channels;
+	    for (auto& event: g.messages) {
+	       ++channels[event.substr(0, event.rfind('.'))];
+	    }
+	    for (auto& [channel, count]: channels) {
+	       out << "   messages of " << channel << ": " << count <<
+		  std::endl;
+	    }
+	    bool first = true;
+	    for (Point point = 0; point < g.points.size(); ++point) {
+	       if (hits(g, point) > 0) continue;
+	       if (first) {
+		  out << "not exercised:" << std::endl;
+		  first = false;
+	       }
+	       auto& p = g.points[point];
+	       out << "   " << filename << ":" << p.line << ":" <<
+		  p.column << ": " << singular[p.kind] << " " <<
+		  p.label << std::endl;
+	    }
+	 }
+
+	 /* copy of the source where each line is preceded by the
+	    smallest hit count of the points of that line,
+	    by ##### if one of them was not hit, or by - if the line
+	    has no coverage points */
+	 static bool write_annotated_source(const std::string& filename,
+	       const std::string& outname) {
+	    std::ifstream in(filename);
+	    std::ofstream out(outname);
+	    if (!in || !out) return false;
+	    auto& g = global();
+	    std::lock_guard<std::mutex> lock(g.mutex);
+	    std::map<int, std::uint64_t> lines;
+	    for (Point point = 0; point < g.points.size(); ++point) {
+	       auto line = g.points[point].line;
+	       auto count = hits(g, point);
+	       auto it = lines.find(line);
+	       if (it == lines.end()) {
+		  lines[line] = count;
+	       } else {
+		  it->second = std::min(it->second, count);
+	       }
+	    }
+	    std::string text;
+	    for (int line = 1; std::getline(in, text); ++line) {
+	       out << std::setw(10);
+	       auto it = lines.find(line);
+	       if (it == lines.end()) {
+		  out << "-";
+	       } else if (it->second == 0) {
+		  out << "#####";
+	       } else {
+		  out << it->second;
+	       }
+	       out << ": " << std::setw(5) << line << ": " << text <<
+		  std::endl;
+	    }
+	    return bool(out);
+	 }
+
+      private:
+	 struct PointInfo {
+	    Kind kind;
+	    int line;
+	    int column;
+	    std::string label;
+	 };
+	 struct Global {
+	    std::mutex mutex;
+	    std::vector<PointInfo> points;
+	    std::vector<std::uint64_t> hits;
+	    std::unordered_set<std::string> messages;
+	 };
+	 /* counters of one thread, indexed by points */
+	 struct Local {
+	    std::vector<std::uint64_t> hits;
+	    std::vector<Kind> kinds; // cached, kinds if not known yet
+	    std::unordered_set<std::string> messages;
+	    ~Local() {
+	       auto& g = global();
+	       std::lock_guard<std::mutex> lock(g.mutex);
+	       if (g.hits.size() < hits.size()) g.hits.resize(hits.size());
+	       for (std::size_t i = 0; i < hits.size(); ++i) {
+		  g.hits[i] += hits[i];
+	       }
+	       g.messages.insert(messages.begin(), messages.end());
+	    }
+	 };
+
+	 inline static bool on = false;
+
+	 static Global& global() {
+	    static Global g;
+	    return g;
+	 }
+	 static Local& get_local() {
+	    thread_local Local local;
+	    return local;
+	 }
+	 static std::uint64_t hits(const Global& g, Point point) {
+	    return point < g.hits.size()? g.hits[point]: 0;
+	 }
+   };
+
+} // namespace CSP
+
+#endif
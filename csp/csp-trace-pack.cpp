@@ -0,0 +1,88 @@
+/* 
+   Copyright (c) 2011-2024 Andreas F. Borchert
+   All rights reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining
+   a copy of this software and associated documentation files (the
+   "Software"), to deal in the Software without restriction, including
+   without limitation the rights to use, copy, modify, merge, publish,
+   distribute, sublicense, and/or sell copies of the Software, and to
+   permit persons to whom the Software is furnished to do so, subject to
+   the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+   KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+   BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+*/
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <string_view>
+
+#include "event-reader.hpp"
+#include "trace-format.hpp"
+
+/* convert text traces into the binary trace format, see trace-format.hpp */
+
+using namespace CSP;
+
+void usage(const char* cmdname) {
+   std::cerr << "Usage: " << cmdname << " [-l] [traces]" << std::endl;
+   std::cerr << "Options:" << std::endl;
+   std::cerr << " -l         one trace per line" << std::endl;
+   std::exit(1);
+}
+
+int main(int argc, char** argv) {
+   const char* cmdname = *argv++; --argc;
+   bool opt_l = false; // one trace per line
+   while (argc > 0 && **argv == '-' && argv[0][1]) {
+      if (std::string_view(*argv) == "-l") {
+	 opt_l = true;
+      } else {
+	 usage(cmdname);
+      }
+      --argc; ++argv;
+   }
+   if (argc > 1) usage(cmdname);
+   int fd = 0;
+   if (argc > 0) {
+      fd = open(*argv, O_RDONLY);
+      if (fd < 0) {
+	 std::cerr << cmdname << ": unable to open " << *argv <<
+	    " for reading" << std::endl;
+	 std::exit(1);
+      }
+   }
+   EventReader in(fd);
+   BinaryTraceWriter writer(opt_l);
+   std::string_view event;
+   if (opt_l) {
+      std::string_view line;
+      while (in.next_line(line)) {
+	 while (EventReader::next_token(line, event)) {
+	    writer.add_event(event);
+	 }
+	 writer.end_trace();
+      }
+   } else {
+      while (in.next(event)) {
+	 writer.add_event(event);
+      }
+   }
+   writer.write(std::cout);
+   std::cout.flush();
+   if (!std::cout) {
+      std::cerr << cmdname << ": write error" << std::endl;
+      std::exit(1);
+   }
+}
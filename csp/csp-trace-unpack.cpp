@@ -0,0 +1,85 @@
+/* 
+   Copyright (c) 2011-2024 Andreas F. Borchert
+   All rights reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining
+   a copy of this software and associated documentation files (the
+   "Software"), to deal in the Software without restriction, including
+   without limitation the rights to use, copy, modify, merge, publish,
+   distribute, sublicense, and/or sell copies of the Software, and to
+   permit persons to whom the Software is furnished to do so, subject to
+   the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+   KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+   BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+*/
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <string_view>
+
+#include "event-reader.hpp"
+#include "trace-format.hpp"
+
+/* convert binary traces back into text, see trace-format.hpp;
+   framed traces are printed one per line, otherwise
+   one event per line */
+
+using namespace CSP;
+
+int main(int argc, char** argv) {
+   const char* cmdname = *argv++; --argc;
+   if (argc > 1) {
+      std::cerr << "Usage: " << cmdname << " [traces]" << std::endl;
+      std::exit(1);
+   }
+   int fd = 0;
+   if (argc > 0) {
+      fd = open(*argv, O_RDONLY);
+      if (fd < 0) {
+	 std::cerr << cmdname << ": unable to open " << *argv <<
+	    " for reading" << std::endl;
+	 std::exit(1);
+      }
+   }
+   EventReader in(fd);
+   BinaryTraceReader reader(in);
+   if (!reader.read_header()) {
+      std::cerr << cmdname << ": not a binary trace" << std::endl;
+      std::exit(1);
+   }
+   std::ios_base::sync_with_stdio(false);
+   bool framed = reader.is_framed();
+   bool first = true;
+   std::string_view event;
+   for (;;) {
+      auto item = reader.next(event);
+      if (item == BinaryTraceReader::event) {
+	 if (framed) {
+	    if (!first) std::cout << ' ';
+	    first = false;
+	    std::cout << event;
+	 } else {
+	    std::cout << event << '\n';
+	 }
+      } else if (item == BinaryTraceReader::end_of_trace) {
+	 std::cout << '\n'; first = true;
+      } else if (item == BinaryTraceReader::end) {
+	 break;
+      } else {
+	 std::cerr << cmdname << ": corrupted binary trace" << std::endl;
+	 std::exit(1);
+      }
+   }
+   std::cout.flush();
+}
@@ -0,0 +1,366 @@
+/* 
+   Copyright (c) 2011-2024 Andreas F. Borchert
+   All rights reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining
+   a copy of this software and associated documentation files (the
+   "Software"), to deal in the Software without restriction, including
+   without limitation the rights to use, copy, modify, merge, publish,
+   distribute, sublicense, and/or sell copies of the Software, and to
+   permit persons to whom the Software is furnished to do so, subject to
+   the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+   KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+   BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+*/
+
+/*
+   cspd loads CSP models once and checks traces on behalf of
+   clients which connect through a Unix domain socket.
+
+   The protocol is line-based; each request is answered by
+   exactly one line:
+
+      models                 ok name...
+      check model event...   accepted
+			     refused k event
+			     not-in-alphabet k event
+      open model             ok
+      step event             accepted | terminated | refused |
+			     not-in-alphabet
+      acceptable             ok event...
+      close                  ok
+      quit                   (the connection is closed)
+
+   Errors are reported as "error message". A connection has at most
+   one open session that is stepped through open, step, acceptable,
+   and close. Each connection is served by a thread of its own
+   while the number of requests that are worked on at the same time
+   is limited by -j; all threads share the models.
+*/
+
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "event-reader.hpp"
+#include "model.hpp"
+#include "session.hpp"
+#include "uniformint.hpp"
+
+using namespace CSP;
+
+void usage(const char* cmdname) {
+   std::cerr << "Usage: " << cmdname <<
+      " [-j threads] [-S seed] socket source.csp..." << std::endl;
+   std::cerr << "Options:" << std::endl;
+   std::cerr << " -j threads number of requests handled concurrently" <<
+      std::endl;
+   std::cerr << " -S seed    seed for the pseudo random generator" <<
+      std::endl;
+   std::exit(1);
+}
+
+/* model name: file name without directory and suffix */
+std::string get_model_name(std::string filename) {
+   auto slash = filename.rfind('/');
+   if (slash != std::string::npos) filename = filename.substr(slash + 1);
+   auto dot = filename.rfind(".csp");
+   if (dot != std::string::npos && dot + 4 == filename.size()) {
+      filename = filename.substr(0, dot);
+   }
+   return filename;
+}
+
+std::map<std::string, ModelPtr> models;
+std::uint64_t seed = 0; // parameter of -S
+
+/* state of one connection */
+struct Connection {
+   int fd;
+   std::unique_ptr<Session> session; // if open
+};
+
+ModelPtr find_model(const std::string& name) {
+   auto it = models.find(name);
+   if (it == models.end()) return nullptr;
+   return it->second;
+}
+
+std::string check(ModelPtr model, std::string_view events) {
+   Session session(model, seed);
+   std::string_view event;
+   std::size_t position = 0;
+   while (EventReader::next_token(events, event)) {
+      ++position;
+      if (session.accepts_success()) break;
+      auto result = session.step(event);
+      if (result == Session::not_in_alphabet) {
+	 std::ostringstream os;
+	 os << "not-in-alphabet " << position << " " << event;
+	 return os.str();
+      }
+      if (result == Session::refused) {
+	 std::ostringstream os;
+	 os << "refused " << position << " " << event;
+	 return os.str();
+      }
+   }
+   return "accepted";
+}
+
+/* process one request; false is returned if
+   the connection is to be closed */
+bool handle(Connection& conn, std::string_view request,
+      std::string& reply) {
+   std::string_view word;
+   if (!EventReader::next_token(request, word)) {
+      reply = "error empty request"; return true;
+   }
+   std::string_view arg;
+   if (word == "quit") {
+      return false;
+   } else if (word == "models") {
+      reply = "ok";
+      for (auto& [name, model]: models) {
+	 reply += ' '; reply += name;
+      }
+   } else if (word == "check" || word == "open") {
+      if (!EventReader::next_token(request, arg)) {
+	 reply = "error model missing"; return true;
+      }
+      auto model = find_model(std::string(arg));
+      if (!model) {
+	 reply = "error unknown model"; return true;
+      }
+      if (word == "check") {
+	 reply = check(model, request);
+      } else {
+	 conn.session = std::make_unique<Session>(model, seed);
+	 reply = "ok";
+      }
+   } else if (word == "close") {
+      conn.session = nullptr;
+      reply = "ok";
+   } else if ((word == "acceptable" || word == "step") && !conn.session) {
+      reply = "error no open session";
+   } else if (word == "acceptable") {
+      reply = "ok";
+      for (auto& event: conn.session->acceptable()) {
+	 reply += ' '; reply += event;
+      }
+   } else if (word == "step") {
+      if (!EventReader::next_token(request, arg)) {
+	 reply = "error event missing"; return true;
+      }
+      switch (conn.session->step(arg)) {
+	 case Session::accepted:
+	    reply = "accepted"; break;
+	 case Session::terminated:
+	    reply = "terminated"; break;
+	 case Session::refused:
+	    reply = "refused"; break;
+	 case Session::not_in_alphabet:
+	    reply = "not-in-alphabet"; break;
+      }
+   } else {
+      reply = "error unknown request";
+   }
+   return true;
+}
+
+bool write_all(int fd, const std::string& data) {
+   std::size_t written = 0;
+   while (written < data.size()) {
+      auto nbytes = send(fd, data.data() + written, data.size() - written,
+	 MSG_NOSIGNAL);
+      if (nbytes < 0) {
+	 if (errno == EINTR) continue;
+	 return false;
+      }
+      written += nbytes;
+   }
+   return true;
+}
+
+/* number of requests that may be handled right now, see -j;
+   idle connections do not count */
+std::mutex slots_mutex;
+std::condition_variable slots_cv;
+unsigned int slots = 0;
+
+bool handle_in_slot(Connection& conn, std::string_view request,
+      std::string& reply) {
+   {
+      std::unique_lock<std::mutex> lock(slots_mutex);
+      slots_cv.wait(lock, []() { return slots > 0; });
+      --slots;
+   }
+   bool ok = handle(conn, request, reply);
+   {
+      std::lock_guard<std::mutex> lock(slots_mutex);
+      ++slots;
+   }
+   slots_cv.notify_one();
+   return ok;
+}
+
+void serve(int fd) {
+   Connection conn{fd};
+   EventReader in(fd);
+   std::string_view request;
+   std::string reply;
+   while (in.next_line(request)) {
+      if (!handle_in_slot(conn, request, reply)) break;
+      reply += '\n';
+      if (!write_all(fd, reply)) break;
+   }
+   close(fd);
+}
+
+char socket_path[sizeof(sockaddr_un::sun_path)];
+/* identity of the socket we created at socket_path, if any */
+volatile std::sig_atomic_t socket_created = 0;
+dev_t socket_dev; ino_t socket_ino;
+
+/* remove socket_path only if it is still the socket we created */
+void remove_socket() {
+   struct stat sb;
+   if (socket_created && lstat(socket_path, &sb) == 0 &&
+	 S_ISSOCK(sb.st_mode) &&
+	 sb.st_dev == socket_dev && sb.st_ino == socket_ino) {
+      unlink(socket_path);
+   }
+}
+
+extern "C" void cleanup(int) {
+   remove_socket();
+   _exit(0);
+}
+
+int main(int argc, char** argv) {
+   const char* cmdname = *argv++; --argc;
+   unsigned int threads = std::thread::hardware_concurrency();
+   if (threads == 0) threads = 1;
+   bool opt_S = false;
+   auto get_arg = [&](char*& cp) -> std::uint64_t {
+      char* arg = cp+1;
+      if (!*arg) {
+	 --argc; ++argv;
+	 if (argc == 0) usage(cmdname);
+	 arg = *argv;
+      }
+      char* endptr;
+      auto value = std::strtoull(arg, &endptr, 10);
+      if (endptr == arg || *endptr) usage(cmdname);
+      cp = endptr-1;
+      return value;
+   };
+   while (argc > 0 && **argv == '-') {
+      for (char* cp = *argv + 1; *cp; ++cp) {
+	 switch (*cp) {
+	    case 'j':
+	       threads = get_arg(cp);
+	       if (threads == 0) usage(cmdname);
+	       break;
+	    case 'S':
+	       opt_S = true; seed = get_arg(cp); break;
+	    default:
+	       usage(cmdname); break;
+	 }
+      }
+      --argc; ++argv;
+   }
+   if (argc < 2) usage(cmdname);
+   const char* path = *argv++; --argc;
+   if (std::strlen(path) >= sizeof socket_path) {
+      std::cerr << cmdname << ": socket path too long" << std::endl;
+      std::exit(1);
+   }
+   std::strcpy(socket_path, path);
+   if (!opt_S) {
+      seed = UniformIntDistribution::random_seed();
+   }
+
+   for (; argc > 0; --argc, ++argv) {
+      auto model = Model::load_file(*argv);
+      if (!model) {
+	 std::cerr << cmdname << ": unable to load " << *argv << std::endl;
+	 std::exit(1);
+      }
+      auto name = get_model_name(*argv);
+      if (models.find(name) != models.end()) {
+	 std::cerr << cmdname << ": model name " << name <<
+	    " of " << *argv << " is already taken" << std::endl;
+	 std::exit(1);
+      }
+      models[name] = model;
+   }
+
+   int sfd = socket(AF_UNIX, SOCK_STREAM, 0);
+   if (sfd < 0) {
+      std::perror("socket"); std::exit(1);
+   }
+   sockaddr_un address = {};
+   address.sun_family = AF_UNIX;
+   std::strcpy(address.sun_path, socket_path);
+   /* remove a stale socket but nothing else */
+   struct stat sb;
+   if (lstat(socket_path, &sb) == 0) {
+      if (!S_ISSOCK(sb.st_mode)) {
+	 std::cerr << cmdname << ": " << socket_path <<
+	    " exists and is not a socket" << std::endl;
+	 std::exit(1);
+      }
+      unlink(socket_path);
+   }
+   if (bind(sfd, reinterpret_cast<sockaddr*>(&address),
+	 sizeof address) < 0) {
+      std::perror(socket_path); std::exit(1);
+   }
+   if (lstat(socket_path, &sb) == 0) {
+      socket_dev = sb.st_dev; socket_ino = sb.st_ino;
+      socket_created = 1;
+   }
+   if (listen(sfd, SOMAXCONN) < 0) {
+      std::perror(socket_path); remove_socket(); std::exit(1);
+   }
+   std::signal(SIGINT, cleanup);
+   std::signal(SIGTERM, cleanup);
+   std::signal(SIGPIPE, SIG_IGN);
+
+   slots = threads;
+   for (;;) {
+      int fd = accept(sfd, nullptr, nullptr);
+      if (fd < 0) {
+	 if (errno == EINTR) continue;
+	 std::perror("accept"); std::exit(1);
+      }
+      std::thread(serve, fd).detach();
+   }
+}
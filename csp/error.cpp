@@ -26,6 +26,7 @@
 #include <cstdlib>
 #include <iostream>
 #include <iomanip>
+#include <mutex>
 
 #include "context.hpp"
 #include "error.hpp"
@@ -34,6 +35,10 @@
 
 namespace CSP {
 
+/* errors may be reported at run time by processes
+   which are shared among multiple threads */
+static std::mutex error_mutex;
+
 static void print_error(const location& loc, char const* msg) {
    /* we have to output locations ourselves as the corresponding
       output operator as provided by bison is broken */
@@ -58,11 +63,13 @@ static void print_error(const location& loc, char const* msg) {
 }
 
 void yyerror(const location& loc, char const* msg) {
+   std::lock_guard<std::mutex> lock(error_mutex);
    print_error(loc, msg);
    std::exit(1);
 }
 
 void yyerror(const location& loc, Context& context, char const* msg) {
+   std::lock_guard<std::mutex> lock(error_mutex);
    print_error(loc, msg);
    for (auto ln = loc.begin.line; ln <= loc.end.line; ++ln) {
       std::cerr << std::setw(5) << ln << " | " <<
@@ -83,7 +90,6 @@ void yyerror(const location& loc, Context& context, char const* msg) {
 
 void parser::error(const location_type& loc, const std::string& msg) {
    yyerror(loc, csp_context, msg.c_str());
-   std::exit(1);
 }
 
 } // namespace CSP
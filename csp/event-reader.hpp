@@ -0,0 +1,238 @@
+/* 
+   Copyright (c) 2011-2024 Andreas F. Borchert
+   All rights reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining
+   a copy of this software and associated documentation files (the
+   "Software"), to deal in the Software without restriction, including
+   without limitation the rights to use, copy, modify, merge, publish,
+   distribute, sublicense, and/or sell copies of the Software, and to
+   permit persons to whom the Software is furnished to do so, subject to
+   the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+   KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+   BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+*/
+
+#ifndef CSP_EVENT_READER_HPP
+#define CSP_EVENT_READER_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace CSP {
+
+   /*
+      An event reader delivers the whitespace-separated events
+      of a file descriptor as string views which remain valid
+      until the next invocation of one of the next functions.
+      Regular files are mapped into memory, everything else,
+      e.g. pipes or terminals, is read in large blocks.
+   */
+   class EventReader {
+      public:
+	 /* fd is not closed by the reader */
+	 EventReader(int fd) : fd(fd) {
+	    struct stat sb;
+	    if (fstat(fd, &sb) == 0 && S_ISREG(sb.st_mode)) {
+	       off_t offset = lseek(fd, 0, SEEK_CUR);
+	       if (offset < 0) offset = 0;
+	       if (sb.st_size <= offset) {
+		  eof = true; return;
+	       }
+	       mapped_size = sb.st_size;
+	       void* p = mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE,
+		  fd, 0);
+	       if (p != MAP_FAILED) {
+		  madvise(p, mapped_size, MADV_SEQUENTIAL);
+		  mapped = static_cast<const char*>(p);
+		  pos = mapped + offset; end = mapped + mapped_size;
+		  eof = true;
+		  return;
+	       }
+	       mapped_size = 0;
+	    }
+	    buffer.resize(1 << 16);
+	    pos = end = buffer.data();
+	 }
+
+	 ~EventReader() {
+	    if (mapped) {
+	       munmap(const_cast<char*>(mapped), mapped_size);
+	    }
+	 }
+
+	 EventReader(const EventReader&) = delete;
+	 EventReader& operator=(const EventReader&) = delete;
+
+	 /* fetch the next event; false is returned at the end */
+	 bool next(std::string_view& event) {
+	    std::size_t scanned = 0;
+	    for (;;) {
+	       pos = skip_space(pos, end);
+	       if (pos == end) {
+		  if (!fill()) return false;
+		  continue;
+	       }
+	       auto token_end = skip_token(pos + scanned, end);
+	       if (token_end == end && !eof) {
+		  /* the event may continue in the next block */
+		  scanned = token_end - pos;
+		  fill();
+		  continue;
+	       }
+	       event = std::string_view(pos, token_end - pos);
+	       pos = token_end;
+	       return true;
+	    }
+	 }
+
+	 /* fetch the next line without its line terminator;
+	    false is returned at the end */
+	 bool next_line(std::string_view& line) {
+	    std::size_t scanned = 0;
+	    for (;;) {
+	       const char* nl = nullptr;
+	       if (pos + scanned < end) {
+		  nl = static_cast<const char*>(std::memchr(pos + scanned,
+		     '\n', end - pos - scanned));
+	       }
+	       if (nl) {
+		  line = std::string_view(pos, nl - pos);
+		  pos = nl + 1;
+		  return true;
+	       }
+	       scanned = end - pos;
+	       if (!fill()) break;
+	    }
+	    if (pos == end) return false;
+	    line = std::string_view(pos, end - pos);
+	    pos = end;
+	    return true;
+	 }
+
+	 /* returns true if the pending input starts with prefix;
+	    nothing is consumed and no more input is read than
+	    necessary to see a mismatch, i.e. interactive input
+	    is not blocked */
+	 bool starts_with(std::string_view prefix) {
+	    for (;;) {
+	       auto len = std::min(std::size_t(end - pos), prefix.size());
+	       if (std::string_view(pos, len) != prefix.substr(0, len)) {
+		  return false;
+	       }
+	       if (len == prefix.size()) return true;
+	       if (!fill()) return false;
+	    }
+	 }
+
+	 /* fetch the next byte; false is returned at the end */
+	 bool next_byte(unsigned char& byte) {
+	    if (pos == end && !fill()) return false;
+	    byte = *pos++;
+	    return true;
+	 }
+
+	 /* fetch the next len bytes; false is returned
+	    if less than len bytes are left */
+	 bool next_bytes(std::size_t len, std::string_view& bytes) {
+	    while (std::size_t(end - pos) < len) {
+	       if (!fill()) return false;
+	    }
+	    bytes = std::string_view(pos, len);
+	    pos += len;
+	    return true;
+	 }
+
+	 /* fetch the next event from text, if there is any,
+	    and remove it from text */
+	 static bool next_token(std::string_view& text,
+	       std::string_view& token) {
+	    auto s = skip_space(text.data(), text.data() + text.size());
+	    auto t = skip_token(s, text.data() + text.size());
+	    if (s == t) return false;
+	    token = std::string_view(s, t - s);
+	    text.remove_prefix(t - text.data());
+	    return true;
+	 }
+
+      private:
+	 int fd;
+	 const char* mapped = nullptr;
+	 std::size_t mapped_size = 0;
+	 std::vector<char> buffer; // if not mapped
+	 const char* pos = nullptr; // not yet consumed data
+	 const char* end = nullptr;
+	 bool eof = false;
+
+	 /* move the pending data to the front of the buffer
+	    and append the next block; false is returned if
+	    there is nothing left to be read */
+	 bool fill() {
+	    if (eof) return false;
+	    std::size_t offset = pos - buffer.data();
+	    std::size_t pending = end - pos;
+	    if (pending == buffer.size()) {
+	       buffer.resize(2 * buffer.size());
+	    }
+	    std::memmove(buffer.data(), buffer.data() + offset, pending);
+	    pos = buffer.data(); end = pos + pending;
+	    ssize_t nbytes;
+	    do {
+	       nbytes = read(fd, buffer.data() + pending,
+		  buffer.size() - pending);
+	    } while (nbytes < 0 && errno == EINTR);
+	    if (nbytes <= 0) {
+	       eof = true; return false;
+	    }
+	    end += nbytes;
+	    return true;
+	 }
+
+	 static bool is_space(char ch) {
+	    return ch == ' ' || ch == '\n' || ch == '\t' ||
+	       ch == '\r' || ch == '\f' || ch == '\v';
+	 }
+
+	 static const char* skip_space(const char* s, const char* end) {
+	    while (s < end && is_space(*s)) ++s;
+	    return s;
+	 }
+
+	 /* return the end of the event starting at s;
+	    eight bytes are inspected at once as long as none
+	    of them can be a whitespace character */
+	 static const char* skip_token(const char* s, const char* end) {
+	    constexpr std::uint64_t ones = 0x0101010101010101;
+	    constexpr std::uint64_t highs = 0x8080808080808080;
+	    while (end - s >= 8) {
+	       std::uint64_t word;
+	       std::memcpy(&word, s, sizeof word);
+	       /* non-zero if one of the bytes is less than '!' */
+	       if ((word - ones * '!') & ~word & highs) break;
+	       s += 8;
+	    }
+	    while (s < end && !is_space(*s)) ++s;
+	    return s;
+	 }
+   };
+
+} // namespace CSP
+
+#endif
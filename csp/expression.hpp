@@ -28,14 +28,14 @@
 
 #include <cassert>
 #include <cstdlib>
-#include <functional>
 #include <iostream>
 #include <memory>
 #include <string>
-#include <utility>
+#include <vector>
 
 #include "context.hpp"
 #include "error.hpp"
+#include "identifier.hpp"
 #include "location.hh"
 #include "object.hpp"
 #include "status.hpp"
@@ -46,9 +46,19 @@ namespace CSP {
    using ExpressionPtr = std::shared_ptr<Expression>;
    using Value = unsigned long;
 
+   class ExpressionCode;
+   class Variable;
+
    class Expression: public Object {
       public:
 	 virtual Value eval(StatusPtr status) const = 0;
+	 /* append the instructions which leave the value
+	    of this expression on top of the stack */
+	 virtual void compile(ExpressionCode& code) const = 0;
+	 /* true if the value does not depend on the status */
+	 virtual bool is_constant() const {
+	    return false;
+	 }
    };
 
    inline std::ostream& operator<<(std::ostream& out,
@@ -56,6 +66,45 @@ namespace CSP {
       expr->print(out); return out;
    }
 
+   /* compact stack-based code for an expression which avoids
+      the virtual calls of walking the expression tree */
+   class ExpressionCode {
+      public:
+	 enum Opcode {push, load, add, sub, mul, div, mod};
+	 struct Instruction {
+	    Opcode opcode;
+	    Value value; // for push
+	    const Variable* variable; // for load
+	 };
+
+	 ExpressionCode(ExpressionPtr expression) : expression(expression) {
+	    expression->compile(*this);
+	    if (max_depth > max_stack) {
+	       /* rare case; we fall back to the expression tree */
+	       code.clear();
+	    }
+	 }
+
+	 void emit(Opcode opcode, Value value = 0,
+	       const Variable* variable = nullptr) {
+	    code.push_back({opcode, value, variable});
+	    if (opcode == push || opcode == load) {
+	       if (++depth > max_depth) max_depth = depth;
+	    } else {
+	       --depth;
+	    }
+	 }
+
+	 inline Value eval(const StatusPtr& status) const;
+
+      private:
+	 static constexpr std::size_t max_stack = 32;
+	 ExpressionPtr expression;
+	 std::vector<Instruction> code;
+	 std::size_t depth = 0;
+	 std::size_t max_depth = 0;
+   };
+
    class Variable: public Expression {
       public:
 	 Variable(const location& loc, Context& context,
@@ -63,64 +112,144 @@ namespace CSP {
 	       loc(loc), context(context), varname(varname) {
 	 }
 	 Value eval(StatusPtr status) const override {
-	    auto sval = status->lookup<Identifier>(varname)->get_name();
-	    const char* s = sval.c_str();
-	    char* endptr;
-	    auto val = std::strtoul(s, &endptr, 10);
-	    if (*endptr) {
-	       yyerror(loc, context,
-		  "bound variable %s is not of integer type");
-	       return 0;
-	    }
-	    return val;
+	    return value_of(*status->lookup<Identifier>(varname));
+	 }
+	 void compile(ExpressionCode& code) const override {
+	    code.emit(ExpressionCode::load, 0, this);
 	 }
 	 void print(std::ostream& out) const override {
 	    out << varname;
 	 }
       private:
+	 friend class ExpressionCode;
 	 const location loc;
 	 Context& context;
 	 std::string varname;
+
+	 Value value_of(const Identifier& id) const {
+	    if (!id.is_integer()) {
+	       yyerror(loc, context,
+		  "bound variable %s is not of integer type", varname);
+	       return 0;
+	    }
+	    return id.get_value();
+	 }
    };
 
    class Integer: public Expression {
       public:
 	 Integer(Value value) : value(value) {
 	 }
+	 /* result of constant folding which is printed
+	    like the original expression */
+	 Integer(Value value, ExpressionPtr origin) :
+	       value(value), origin(origin) {
+	 }
 	 Value eval(StatusPtr status) const override {
 	    return value;
 	 }
+	 void compile(ExpressionCode& code) const override {
+	    code.emit(ExpressionCode::push, value);
+	 }
+	 bool is_constant() const override {
+	    return true;
+	 }
 	 void print(std::ostream& out) const override {
-	    out << value;
+	    if (origin) {
+	       origin->print(out);
+	    } else {
+	       out << value;
+	    }
 	 }
 
       private:
 	 Value value;
+	 ExpressionPtr origin;
    };
 
    class Binary: public Expression {
       public:
-	 template<typename F>
-	 Binary(ExpressionPtr left, ExpressionPtr right,
-	       std::string opsym, F&& f) :
-	       left(left), right(right), opsym(opsym), f(std::forward<F>(f)) {
+	 enum Operator {add, sub, mul, div, mod};
+
+	 Binary(ExpressionPtr left, ExpressionPtr right, Operator op) :
+	       left(left), right(right), op(op) {
 	 }
 	 Value eval(StatusPtr status) const override {
-	    auto v1 = left->eval(status);
-	    auto v2 = right->eval(status);
-	    return f(v1, v2);
+	    return apply(op, left->eval(status), right->eval(status));
+	 }
+	 void compile(ExpressionCode& code) const override {
+	    left->compile(code);
+	    right->compile(code);
+	    code.emit(opcodes[op]);
 	 }
 	 void print(std::ostream& out) const override {
-	    out << "(" << left << " " << opsym << " " << right << ")";
+	    out << "(" << left << " " << opsyms[op] << " " << right << ")";
+	 }
+
+	 static Value apply(Operator op, Value v1, Value v2) {
+	    switch (op) {
+	       case add: return v1 + v2;
+	       case sub: return v1 - v2;
+	       case mul: return v1 * v2;
+	       case div: return v1 / v2;
+	       case mod: return v1 % v2;
+	    }
+	    return 0;
+	 }
+
+	 /* returns a Binary expression, or an Integer if
+	    both operands are constant; divisions by zero
+	    are left to the evaluation */
+	 static ExpressionPtr make(ExpressionPtr left, ExpressionPtr right,
+	       Operator op) {
+	    auto expr = std::make_shared<Binary>(left, right, op);
+	    if (left->is_constant() && right->is_constant()) {
+	       auto v2 = right->eval(nullptr);
+	       if (v2 != 0 || (op != div && op != mod)) {
+		  return std::make_shared<Integer>(
+		     apply(op, left->eval(nullptr), v2), expr);
+	       }
+	    }
+	    return expr;
 	 }
 
       private:
+	 static constexpr const char* opsyms[] = {"+", "-", "*", "div", "mod"};
+	 static constexpr ExpressionCode::Opcode opcodes[] = {
+	    ExpressionCode::add, ExpressionCode::sub, ExpressionCode::mul,
+	    ExpressionCode::div, ExpressionCode::mod,
+	 };
 	 ExpressionPtr left;
 	 ExpressionPtr right;
-	 std::string opsym;
-	 std::function<Value(Value, Value)> f;
+	 Operator op;
    };
 
+   inline Value ExpressionCode::eval(const StatusPtr& status) const {
+      if (code.empty()) {
+	 return expression->eval(status);
+      }
+      Value stack[max_stack];
+      std::size_t sp = 0;
+      for (auto& instr: code) {
+	 switch (instr.opcode) {
+	    case push:
+	       stack[sp++] = instr.value;
+	       break;
+	    case load:
+	       stack[sp++] = instr.variable->value_of(
+		  *status->lookup<Identifier>(instr.variable->varname));
+	       break;
+	    case add: --sp; stack[sp-1] += stack[sp]; break;
+	    case sub: --sp; stack[sp-1] -= stack[sp]; break;
+	    case mul: --sp; stack[sp-1] *= stack[sp]; break;
+	    case div: --sp; stack[sp-1] /= stack[sp]; break;
+	    case mod: --sp; stack[sp-1] %= stack[sp]; break;
+	 }
+      }
+      assert(sp == 1);
+      return stack[0];
+   }
+
 } // namespace CSP
 
 #endif
@@ -24,7 +24,8 @@
 */
 
 /*
-   Extension of Process for an external choice the form P1 [] P2
+   Extension of Process for an external choice the form P1 [] P2;
+   nested choices P1 [] P2 [] ... [] Pn are flattened into one node
 */
 
 #ifndef CSP_EXTERNAL_CHOICE_HPP
@@ -34,6 +35,7 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "alphabet.hpp"
 #include "process.hpp"
@@ -44,63 +46,114 @@ namespace CSP {
 
    class ExternalChoice: public Process {
       public:
-	 ExternalChoice(ProcessPtr p, ProcessPtr q) :
-	       process1(p), process2(q) {
-	    assert(process1);
-	    assert(process2);
+	 ExternalChoice(ProcessPtr p, ProcessPtr q) {
+	    add_choice(p);
+	    add_choice(q);
 	 }
 	 void print(std::ostream& out) const override {
-	    process1->print(out); out << " [] "; process2->print(out);
+	    bool first = true;
+	    for (auto& choice: choices) {
+	       if (first) {
+		  first = false;
+	       } else {
+		  out << " [] ";
+	       }
+	       print_subterm(out, choice);
+	    }
 	 }
-	 Alphabet acceptable(StatusPtr status) const final {
+	 Alphabet internal_acceptable(StatusPtr status) const final {
 	    /* if we get asked, we make up our mind */
-	    auto s = get_status<InternalStatus>(status);
-	    return process1->acceptable(s->s1) +
-	       process2->acceptable(s->s2);
+	    auto s = get_owned_status<InternalStatus>(status, this);
+	    update(s);
+	    return s->accepting;
 	 }
 
       private:
 	 struct InternalStatus: public Status {
-	    StatusPtr s1;
-	    StatusPtr s2;
+	    const ExternalChoice* owner;
+	    std::vector<StatusPtr> statuses; // one for each of the choices
+	    /* the acceptable events of our choices do not change
+	       until one of them proceeds which resolves this choice;
+	       hence we compute them just once */
+	    bool cached = false;
+	    std::vector<Alphabet> accepting_choice; // valid if cached
+	    Alphabet accepting; // union of accepting_choice
 
-	    InternalStatus(StatusPtr status) :
-	       Status(status),
-	       s1(std::make_shared<Status>(status)),
-	       s2(std::make_shared<Status>(status)) {
+	    InternalStatus(StatusPtr status, const ExternalChoice* owner) :
+		  Status(status), owner(owner) {
+	       for (std::size_t i = 0; i < owner->choices.size(); ++i) {
+		  statuses.push_back(make_accounted<Status>(status));
+	       }
+	    }
+	    StatusPtr copy() const override {
+	       return make_accounted<InternalStatus>(*this);
+	    }
+	    void clone_members(Cloner& clone) override {
+	       Status::clone_members(clone);
+	       for (auto& s: statuses) {
+		  s = clone(s);
+	       }
 	    }
 	 };
+	 using InternalStatusPtr = std::shared_ptr<InternalStatus>;
+
+	 std::vector<ProcessPtr> choices;
+
+	 void add_choice(ProcessPtr p) {
+	    assert(p);
+	    auto ec = std::dynamic_pointer_cast<ExternalChoice>(p);
+	    if (ec) {
+	       choices.insert(choices.end(),
+		  ec->choices.begin(), ec->choices.end());
+	    } else {
+	       choices.push_back(p);
+	    }
+	 }
 
-	 ProcessPtr process1;
-	 ProcessPtr process2;
+	 void update(InternalStatusPtr s) const {
+	    if (!s->cached) {
+	       s->accepting_choice.clear();
+	       s->accepting = Alphabet();
+	       for (std::size_t i = 0; i < choices.size(); ++i) {
+		  auto a = choices[i]->acceptable(s->statuses[i]);
+		  s->accepting = s->accepting + a;
+		  s->accepting_choice.push_back(std::move(a));
+	       }
+	       s->cached = true;
+	    }
+	 }
 
 	 ActiveProcess internal_proceed(const std::string& event,
 	       StatusPtr status) final {
-	    auto s = get_status<InternalStatus>(status);
-	    Alphabet a1 = process1->acceptable(s->s1);
-	    Alphabet a2 = process2->acceptable(s->s2);
-	    bool ok1 = a1.is_member(event);
-	    bool ok2 = a2.is_member(event);
-	    if (ok1 && ok2) {
-	       if (status->flip()) {
-		  ok1 = false;
-	       } else {
-		  ok2 = false;
+	    auto s = get_owned_status<InternalStatus>(status, this);
+	    update(s);
+	    std::vector<std::size_t> candidates;
+	    for (std::size_t i = 0; i < choices.size(); ++i) {
+	       if (s->accepting_choice[i].is_member(event)) {
+		  candidates.push_back(i);
 	       }
 	    }
-	    if (ok1) {
-	       return process1->proceed(event, s->s1);
-	    } else {
-	       return process2->proceed(event, s->s2);
+	    if (candidates.empty()) {
+	       return {nullptr, status};
+	    }
+	    std::size_t index = candidates[0];
+	    if (candidates.size() > 1) {
+	       index = candidates[status->draw(candidates.size())];
 	    }
+	    return choices[index]->proceed(event, s->statuses[index]);
 	 }
 	 Alphabet internal_get_alphabet() const final {
-	    return process1->get_alphabet() + process2->get_alphabet();
+	    Alphabet set;
+	    for (auto& choice: choices) {
+	       set = set + choice->get_alphabet();
+	    }
+	    return set;
 	 }
 	 void initialize_dependencies() const final {
 	    auto me = shared_from_this();
-	    process1->add_dependant(me);
-	    process2->add_dependant(me);
+	    for (auto& choice: choices) {
+	       choice->add_dependant(me);
+	    }
 	 }
    };
 
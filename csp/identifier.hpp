@@ -26,6 +26,8 @@
 #ifndef CSP_IDENTIFIER_HPP
 #define CSP_IDENTIFIER_HPP
 
+#include <cctype>
+#include <cstdlib>
 #include <iostream>
 #include <string>
 
@@ -39,6 +41,7 @@ namespace CSP {
    class Identifier: public Object {
       public:
 	 Identifier(const std::string& name) : name(name) {
+	    convert();
 	 }
 	 Identifier(IdentifierPtr qualifier, const std::string& name) :
 	       name(qualifier->get_name() + "." + name) {
@@ -50,11 +53,35 @@ namespace CSP {
 	 const std::string& get_name() const {
 	    return name;
 	 }
+	 /* names that are decimal numbers are converted once such
+	    that bound variables can be used in integer expressions
+	    without converting them on each evaluation */
+	 bool is_integer() const {
+	    return integer;
+	 }
+	 unsigned long get_value() const {
+	    return value;
+	 }
 	 void print(std::ostream& out) const override {
 	    out << name;
 	 }
       private:
 	 const std::string name;
+	 bool integer = false;
+	 unsigned long value = 0;
+
+	 void convert() {
+	    if (name.size() == 0) return;
+	    char first = name[0];
+	    if (!std::isdigit(static_cast<unsigned char>(first)) &&
+		  first != '+' && first != '-') {
+	       return;
+	    }
+	    const char* s = name.c_str();
+	    char* endptr;
+	    value = std::strtoul(s, &endptr, 10);
+	    integer = !*endptr;
+	 }
    };
 
 } // namespace CSP
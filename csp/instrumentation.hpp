@@ -0,0 +1,238 @@
+/* 
+   Copyright (c) 2011-2024 Andreas F. Borchert
+   All rights reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining
+   a copy of this software and associated documentation files (the
+   "Software"), to deal in the Software without restriction, including
+   without limitation the rights to use, copy, modify, merge, publish,
+   distribute, sublicense, and/or sell copies of the Software, and to
+   permit persons to whom the Software is furnished to do so, subject to
+   the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+   KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+   BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+*/
+
+#ifndef CSP_INSTRUMENTATION_HPP
+#define CSP_INSTRUMENTATION_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+/*
+   optional counters per operator class, see option --stats of trace;
+   all counts are attributed to the innermost process whose
+   proceed or acceptable method is running at that time,
+   which is "(none)" while a model is loaded;
+   times are self times, i.e. they do not include the time
+   spent in the proceed and acceptable methods of subprocesses
+*/
+
+namespace CSP {
+
+   class Instrumentation {
+      public:
+	 struct Counters {
+	    std::uint64_t proceed_calls = 0;
+	    std::uint64_t acceptable_calls = 0;
+	    std::uint64_t nodes = 0; // process objects created
+	    std::uint64_t statuses = 0; // status objects created
+	    std::uint64_t tau_steps = 0; // concealed events taken
+	    std::chrono::nanoseconds time{0};
+
+	    Counters& operator+=(const Counters& other) {
+	       proceed_calls += other.proceed_calls;
+	       acceptable_calls += other.acceptable_calls;
+	       nodes += other.nodes;
+	       statuses += other.statuses;
+	       tau_steps += other.tau_steps;
+	       time += other.time;
+	       return *this;
+	    }
+	 };
+	 using Totals = std::map<std::string, Counters>;
+
+	 /* set before any counting thread is started
+	    and not changed afterwards */
+	 static bool enabled() {
+	    return on;
+	 }
+	 static void enable() {
+	    global(); // constructed before any atexit handler
+	    on = true;
+	 }
+
+	 /* accounts for one invocation of proceed or acceptable
+	    of the given process */
+	 class Frame {
+	    public:
+	       enum Kind {proceed, acceptable};
+	       Frame(const std::type_info& type, Kind kind) :
+		     top(get_local().top), outer(top),
+		     counters(get_local().counters[std::type_index(type)]),
+		     start(Clock::now()) {
+		  if (kind == proceed) {
+		     ++counters.proceed_calls;
+		  } else {
+		     ++counters.acceptable_calls;
+		  }
+		  top = this;
+	       }
+	       ~Frame() {
+		  auto elapsed = Clock::now() - start;
+		  counters.time += std::chrono::duration_cast<
+		     std::chrono::nanoseconds>(elapsed - inner);
+		  if (outer) outer->inner += elapsed;
+		  top = outer;
+	       }
+	       Frame(const Frame&) = delete;
+	       Frame& operator=(const Frame&) = delete;
+	    private:
+	       friend class Instrumentation;
+	       using Clock = std::chrono::steady_clock;
+	       Frame*& top; // of the current thread
+	       Frame* outer;
+	       Counters& counters;
+	       Clock::time_point start;
+	       Clock::duration inner{0};
+	 };
+
+	 static void count_node() {
+	    ++current().nodes;
+	 }
+	 static void count_status() {
+	    ++current().statuses;
+	 }
+	 static void count_tau_step() {
+	    ++current().tau_steps;
+	 }
+
+	 /* counters of all threads that have terminated;
+	    this includes the main thread if invoked
+	    by a handler registered with std::atexit */
+	 static Totals totals() {
+	    auto& g = global();
+	    std::lock_guard<std::mutex> lock(g.mutex);
+	    return g.totals;
+	 }
+
+	 static void print_table(std::ostream& out) {
+	    auto totals = Instrumentation::totals();
+	    out << std::left << std::setw(24) << "operator" << std::right <<
+	       std::setw(12) << "proceed" << std::setw(12) << "acceptable" <<
+	       std::setw(10) << "nodes" << std::setw(10) << "statuses" <<
+	       std::setw(10) << "tau" << std::setw(12) << "time [ms]" <<
+	       std::endl;
+	    for (auto& [name, c]: totals) {
+	       out << std::left << std::setw(24) << name << std::right <<
+		  std::setw(12) << c.proceed_calls <<
+		  std::setw(12) << c.acceptable_calls <<
+		  std::setw(10) << c.nodes <<
+		  std::setw(10) << c.statuses <<
+		  std::setw(10) << c.tau_steps <<
+		  std::setw(12) << std::fixed << std::setprecision(3) <<
+		  c.time.count() / 1e6 << std::endl;
+	    }
+	 }
+
+	 static void print_json(std::ostream& out) {
+	    auto totals = Instrumentation::totals();
+	    out << "{";
+	    bool first = true;
+	    for (auto& [name, c]: totals) {
+	       if (!first) out << ",";
+	       first = false;
+	       out << "\"" << name << "\":{" <<
+		  "\"proceed\":" << c.proceed_calls << "," <<
+		  "\"acceptable\":" << c.acceptable_calls << "," <<
+		  "\"nodes\":" << c.nodes << "," <<
+		  "\"statuses\":" << c.statuses << "," <<
+		  "\"tau_steps\":" << c.tau_steps << "," <<
+		  "\"time_ns\":" << c.time.count() << "}";
+	    }
+	    out << "}" << std::endl;
+	 }
+
+      private:
+	 using Table = std::unordered_map<std::type_index, Counters>;
+
+	 /* counters of one thread which are added to the
+	    global totals when the thread terminates */
+	 struct Local {
+	    Table counters;
+	    Frame* top = nullptr;
+	    ~Local() {
+	       auto& g = global();
+	       std::lock_guard<std::mutex> lock(g.mutex);
+	       add(g.totals, counters);
+	    }
+	 };
+	 struct Global {
+	    std::mutex mutex;
+	    Totals totals;
+	 };
+
+	 inline static bool on = false;
+
+	 static Local& get_local() {
+	    thread_local Local local;
+	    return local;
+	 }
+	 static Global& global() {
+	    static Global g;
+	    return g;
+	 }
+	 static Counters& current() {
+	    auto& local = get_local();
+	    if (local.top) return local.top->counters;
+	    return local.counters[std::type_index(typeid(void))];
+	 }
+
+	 static void add(Totals& totals, const Table& table) {
+	    for (auto& [type, counters]: table) {
+	       totals[name_of(type)] += counters;
+	    }
+	 }
+
+	 static std::string name_of(std::type_index type) {
+	    if (type == std::type_index(typeid(void))) return "(none)";
+	    std::string name = type.name();
+#ifdef __GNUG__
+	    int status;
+	    std::unique_ptr<char, void(*)(void*)> demangled(
+	       abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status),
+	       std::free);
+	    if (status == 0) name = demangled.get();
+#endif
+	    if (name.compare(0, 5, "CSP::") == 0) name.erase(0, 5);
+	    return name;
+	 }
+   };
+
+} // namespace CSP
+
+#endif
@@ -52,9 +52,10 @@ namespace CSP {
 	    assert(process2);
 	 }
 	 void print(std::ostream& out) const override {
-	    process1->print(out); out << " ||| "; process2->print(out);
+	    print_subterm(out, process1); out << " ||| ";
+	    print_subterm(out, process2);
 	 }
-	 Alphabet acceptable(StatusPtr status) const final {
+	 Alphabet internal_acceptable(StatusPtr status) const final {
 	    auto s = get_status<InternalStatus>(status);
 	    return process1->acceptable(s->s1) +
 	       process2->acceptable(s->s2);
@@ -66,8 +67,15 @@ namespace CSP {
 	    StatusPtr s2;
 	    InternalStatus(StatusPtr status) :
 	       Status(status),
-	       s1(std::make_shared<Status>(status)),
-	       s2(std::make_shared<Status>(status)) {
+	       s1(make_accounted<Status>(status)),
+	       s2(make_accounted<Status>(status)) {
+	    }
+	    StatusPtr copy() const override {
+	       return make_accounted<InternalStatus>(*this);
+	    }
+	    void clone_members(Cloner& clone) override {
+	       Status::clone_members(clone);
+	       s1 = clone(s1); s2 = clone(s2);
 	    }
 	 };
 
@@ -91,13 +99,20 @@ namespace CSP {
 	    ProcessPtr p;
 	    if (ok1) {
 	       std::tie(p, s->s1) = process1->proceed(event, s->s1);
-	       p = std::make_shared<InterleavingProcesses>(p, process2);
+	       p = make_accounted<InterleavingProcesses>(p, process2);
 	    } else if (ok2) {
 	       std::tie(p, s->s2) = process2->proceed(event, s->s2);
-	       p = std::make_shared<InterleavingProcesses>(process1, p);
+	       p = make_accounted<InterleavingProcesses>(process1, p);
 	    } else {
 	       p = nullptr;
 	    }
+	    if (p) {
+	       /* the alphabet remains unchanged */
+	       auto& alphabet = get_alphabet();
+	       if (alphabet.cardinality() > 0) {
+		  p->set_alphabet(alphabet);
+	       }
+	    }
 	    return {p, s};
 	 }
 	 Alphabet internal_get_alphabet() const final {
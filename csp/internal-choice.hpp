@@ -24,7 +24,8 @@
 */
 
 /*
-   Extension of Process for an internal choice of the form P1 |~| P2
+   Extension of Process for an internal choice of the form P1 |~| P2;
+   nested choices P1 |~| P2 |~| ... |~| Pn are flattened into one node
 */
 
 #ifndef CSP_INTERNAL_CHOICE_HPP
@@ -34,6 +35,7 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "alphabet.hpp"
 #include "process.hpp"
@@ -44,71 +46,102 @@ namespace CSP {
 
    class InternalChoice: public Process {
       public:
-	 InternalChoice(ProcessPtr p, ProcessPtr q) :
-	       process1(p), process2(q) {
-	    assert(process1);
-	    assert(process2);
+	 InternalChoice(ProcessPtr p, ProcessPtr q) {
+	    add_choice(p);
+	    add_choice(q);
 	 }
 	 void print(std::ostream& out) const override {
-	    process1->print(out); out << " |~| "; process2->print(out);
+	    bool first = true;
+	    for (auto& choice: choices) {
+	       if (first) {
+		  first = false;
+	       } else {
+		  out << " |~| ";
+	       }
+	       print_subterm(out, choice);
+	    }
 	 }
-	 Alphabet acceptable(StatusPtr status) const final {
-	    auto s = get_status<InternalStatus>(status);
+	 Alphabet internal_acceptable(StatusPtr status) const final {
+	    auto s = get_owned_status<InternalStatus>(status, this);
 	    /* if we get asked, we make up our mind */
 	    decide(s);
-	    if (s->nextmove == InternalStatus::headforp1) {
-	       return process1->acceptable(s->s1);
-	    } else {
-	       return process2->acceptable(s->s2);
+	    if (!s->cached) {
+	       s->accepting = choices[s->nextmove]->acceptable(
+		  s->statuses[s->nextmove]);
+	       s->cached = true;
 	    }
+	    return s->accepting;
 	 }
 
       private:
 	 struct InternalStatus: public Status {
-	    StatusPtr s1;
-	    StatusPtr s2;
-	    enum {undecided, headforp1, headforp2} nextmove = undecided;
-
-	    InternalStatus(StatusPtr status) :
-	       Status(status),
-	       s1(std::make_shared<Status>(status)),
-	       s2(std::make_shared<Status>(status)) {
+	    const InternalChoice* owner;
+	    std::vector<StatusPtr> statuses; // one for each of the choices
+	    static constexpr std::size_t undecided = ~std::size_t(0);
+	    std::size_t nextmove = undecided; // index of the chosen process
+	    bool cached = false;
+	    Alphabet accepting; // valid if cached
+
+	    InternalStatus(StatusPtr status, const InternalChoice* owner) :
+		  Status(status), owner(owner) {
+	       for (std::size_t i = 0; i < owner->choices.size(); ++i) {
+		  statuses.push_back(make_accounted<Status>(status));
+	       }
+	    }
+	    StatusPtr copy() const override {
+	       return make_accounted<InternalStatus>(*this);
+	    }
+	    void clone_members(Cloner& clone) override {
+	       Status::clone_members(clone);
+	       for (auto& s: statuses) {
+		  s = clone(s);
+	       }
 	    }
 	 };
 	 using InternalStatusPtr = std::shared_ptr<InternalStatus>;
 
-	 ProcessPtr process1;
-	 ProcessPtr process2;
+	 std::vector<ProcessPtr> choices;
+
+	 void add_choice(ProcessPtr p) {
+	    assert(p);
+	    auto ic = std::dynamic_pointer_cast<InternalChoice>(p);
+	    if (ic) {
+	       choices.insert(choices.end(),
+		  ic->choices.begin(), ic->choices.end());
+	    } else {
+	       choices.push_back(p);
+	    }
+	 }
 
 	 ActiveProcess internal_proceed(const std::string& event,
 	       StatusPtr status) final {
-	    auto s = get_status<InternalStatus>(status);
+	    auto s = get_owned_status<InternalStatus>(status, this);
 	    decide(s);
-	    ProcessPtr p;
-	    if (s->nextmove == InternalStatus::headforp1) {
-	       std::tie(p, s->s1) = process1->proceed(event, s->s1);
-	    } else {
-	       std::tie(p, s->s2) = process2->proceed(event, s->s2);
-	    }
+	    /* the choice is resolved, i.e. we continue
+	       with the chosen process and its status */
+	    auto index = s->nextmove;
 	    s->nextmove = InternalStatus::undecided;
-	    return {p, s};
+	    s->cached = false;
+	    return choices[index]->proceed(event, s->statuses[index]);
 	 }
 	 Alphabet internal_get_alphabet() const final {
-	    return process1->get_alphabet() + process2->get_alphabet();
+	    Alphabet set;
+	    for (auto& choice: choices) {
+	       set = set + choice->get_alphabet();
+	    }
+	    return set;
 	 }
 	 void decide(InternalStatusPtr s) const {
 	    if (s->nextmove == InternalStatus::undecided) {
-	       if (s->flip()) {
-		  s->nextmove = InternalStatus::headforp1;
-	       } else {
-		  s->nextmove = InternalStatus::headforp2;
-	       }
+	       s->nextmove = s->draw(choices.size());
+	       s->cached = false;
 	    }
 	 }
 	 void initialize_dependencies() const final {
 	    auto me = shared_from_this();
-	    process1->add_dependant(me);
-	    process2->add_dependant(me);
+	    for (auto& choice: choices) {
+	       choice->add_dependant(me);
+	    }
 	 }
    };
 
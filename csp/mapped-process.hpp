@@ -28,6 +28,7 @@
 
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 
@@ -41,28 +42,67 @@ namespace CSP {
    using MappedProcessPtr = std::shared_ptr<MappedProcess>;
 
    class MappedProcess: public Process {
+      private:
+	 /* mappings for the alphabet of process which are computed
+	    once on first use and shared with our successors */
+	 struct Table {
+	    std::once_flag once;
+	    SymbolChangeTablePtr table;
+	 };
+
       public:
 	 MappedProcess(ProcessPtr process, SymbolChangerPtr f) :
 	       f(f), process(process) {
 	    assert(process);
+	    /* nested mappings are fused into one */
+	    auto mp = std::dynamic_pointer_cast<MappedProcess>(process);
+	    if (mp) {
+	       this->f = std::make_shared<Composition>(f, mp->f);
+	       this->process = mp->process;
+	    }
+	 }
+	 /* successor which shares the table of its predecessor */
+	 MappedProcess(ProcessPtr process, SymbolChangerPtr f,
+		  std::shared_ptr<Table> table) :
+	       f(f), process(process), table(table) {
+	    assert(process);
 	 }
 	 void print(std::ostream& out) const override {
-	    std::ostringstream os; process->print(os);
+	    std::ostringstream os; PrintControl::inherit(os, out);
+	    print_subterm(os, process);
 	    out << f->get_name(os.str());
 	 }
-	 Alphabet acceptable(StatusPtr status) const final {
-	    return f->map(process->acceptable(status));
+	 Alphabet internal_acceptable(StatusPtr status) const final {
+	    return get_table().map(process->acceptable(status));
 	 }
 
       private:
 	 SymbolChangerPtr f;
 	 ProcessPtr process;
+	 std::shared_ptr<Table> table = std::make_shared<Table>();
+
+	 /* the alphabet of process is final once we are run */
+	 const SymbolChangeTable& get_table() const {
+	    std::call_once(table->once, [this]() {
+	       table->table = std::make_shared<const SymbolChangeTable>(f,
+		  process->get_alphabet());
+	    });
+	    return *table->table;
+	 }
 
 	 ActiveProcess internal_proceed(const std::string& event,
 	       StatusPtr status) final {
-	    auto [p, s] = process->proceed(f->reverse_map(event), status);
+	    auto [p, s] = process->proceed(get_table().reverse_map(event),
+	       status);
 	    if (!p) return {nullptr, status};
-	    return {std::make_shared<MappedProcess>(p, f), s};
+	    auto successor = make_accounted<MappedProcess>(p, f, table);
+	    /* the alphabet remains unchanged; this saves us
+	       from registering the successor as dependant */
+	    auto& alphabet = get_alphabet();
+	    if (alphabet.cardinality() > 0) {
+	       successor->set_alphabet(alphabet);
+	    }
+	    return {successor, s};
 	 }
 	 Alphabet internal_get_alphabet() const final {
 	    /* mapping is done through map_alphabet below */
@@ -72,6 +112,9 @@ namespace CSP {
 	 Alphabet map_alphabet(const Alphabet& alphabet) const final {
 	    return f->map(alphabet);
 	 }
+	 bool maps_alphabet() const final {
+	    return true;
+	 }
 
 	 void initialize_dependencies() const final {
 	    process->add_dependant(std::dynamic_pointer_cast<const Process>(
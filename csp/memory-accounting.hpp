@@ -0,0 +1,251 @@
+/* 
+   Copyright (c) 2011-2024 Andreas F. Borchert
+   All rights reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining
+   a copy of this software and associated documentation files (the
+   "Software"), to deal in the Software without restriction, including
+   without limitation the rights to use, copy, modify, merge, publish,
+   distribute, sublicense, and/or sell copies of the Software, and to
+   permit persons to whom the Software is furnished to do so, subject to
+   the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+   KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+   BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+*/
+
+#ifndef CSP_MEMORY_ACCOUNTING_HPP
+#define CSP_MEMORY_ACCOUNTING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+
+/*
+   optional accounting of live and peak memory per subsystem,
+   see option --mem-report of trace;
+   process, status, and scope objects are accounted with their
+   full size if they are created by make_accounted, alphabets
+   and their event strings by the allocator of their sets;
+   objects that were created before the accounting was enabled
+   are not accounted
+*/
+
+namespace CSP {
+
+   class MemoryAccounting {
+      public:
+	 enum Category {
+	    processes, statuses, scopes,
+	    alphabet_sets, alphabet_entries, event_strings,
+	    categories // number of categories
+	 };
+
+	 struct Usage {
+	    std::int64_t live_objects;
+	    std::int64_t peak_objects;
+	    std::int64_t live_bytes;
+	    std::int64_t peak_bytes;
+	 };
+
+	 /* set before any object is accounted
+	    and not changed afterwards */
+	 static bool enabled() {
+	    return on;
+	 }
+	 static void enable() {
+	    on = true;
+	 }
+
+	 static void add(Category category, std::size_t bytes,
+	       std::size_t objects = 1) {
+	    auto& c = counters(category);
+	    raise(c.peak_objects, c.live_objects += objects);
+	    raise(c.peak_bytes, c.live_bytes += bytes);
+	 }
+	 static void remove(Category category, std::size_t bytes,
+	       std::size_t objects = 1) {
+	    auto& c = counters(category);
+	    c.live_objects -= objects;
+	    c.live_bytes -= bytes;
+	 }
+
+	 static Usage get_usage(Category category) {
+	    auto& c = counters(category);
+	    return {c.live_objects, c.peak_objects,
+	       c.live_bytes, c.peak_bytes};
+	 }
+
+	 static void print_report(std::ostream& out) {
+	    static const char* names[] = {
+	       "processes", "statuses", "scopes",
+	       "alphabet sets", "alphabet entries", "event strings",
+	    };
+	    out << std::left << std::setw(18) << "subsystem" << std::right <<
+	       std::setw(14) << "live objects" <<
+	       std::setw(14) << "peak objects" <<
+	       std::setw(14) << "live bytes" <<
+	       std::setw(14) << "peak bytes" << std::endl;
+	    for (int i = 0; i < categories; ++i) {
+	       auto usage = get_usage(Category(i));
+	       out << std::left << std::setw(18) << names[i] << std::right <<
+		  std::setw(14) << usage.live_objects <<
+		  std::setw(14) << usage.peak_objects <<
+		  std::setw(14) << usage.live_bytes <<
+		  std::setw(14) << usage.peak_bytes << std::endl;
+	    }
+	 }
+
+      private:
+	 struct Counters {
+	    std::atomic<std::int64_t> live_objects{0};
+	    std::atomic<std::int64_t> peak_objects{0};
+	    std::atomic<std::int64_t> live_bytes{0};
+	    std::atomic<std::int64_t> peak_bytes{0};
+	 };
+	 inline static bool on = false;
+
+	 static Counters& counters(Category category) {
+	    static Counters table[categories];
+	    return table[category];
+	 }
+	 static void raise(std::atomic<std::int64_t>& peak,
+	       std::int64_t value) {
+	    auto current = peak.load();
+	    while (value > current &&
+		  !peak.compare_exchange_weak(current, value)) {
+	    }
+	 }
+   };
+
+   /* base class of objects which are accounted for category
+      if they are created by make_accounted */
+   template<MemoryAccounting::Category category>
+   class Accounted {
+      public:
+	 Accounted() = default;
+	 /* copies are accounted on their own by make_accounted */
+	 Accounted(const Accounted&) {
+	 }
+	 Accounted& operator=(const Accounted&) {
+	    return *this;
+	 }
+	 ~Accounted() {
+	    if (accounted) {
+	       MemoryAccounting::remove(category, accounted);
+	    }
+	 }
+
+	 /* to be invoked once by make_accounted */
+	 void account(std::size_t bytes) {
+	    accounted = bytes;
+	    MemoryAccounting::add(category, accounted);
+	 }
+
+      private:
+	 std::size_t accounted = 0; // bytes
+   };
+
+   /* like std::make_shared but T, which is to be derived from
+      Accounted, is accounted with its full size */
+   template<typename T, typename... Args>
+   std::shared_ptr<T> make_accounted(Args&&... args) {
+      auto object = std::make_shared<T>(std::forward<Args>(args)...);
+      if (MemoryAccounting::enabled()) {
+	 object->account(sizeof(T));
+      }
+      return object;
+   }
+
+   /* allocator which accounts its allocations for the given category,
+      each of them as an object unless objects is false;
+      the heap buffers of the strings it constructs are accounted
+      as event strings */
+   template<typename T, MemoryAccounting::Category category,
+      bool objects = true>
+   class AccountingAllocator {
+      public:
+	 using value_type = T;
+	 template<typename U>
+	 struct rebind {
+	    using other = AccountingAllocator<U, category, objects>;
+	 };
+
+	 AccountingAllocator() = default;
+	 template<typename U>
+	 AccountingAllocator(
+	       const AccountingAllocator<U, category, objects>&) {
+	 }
+
+	 T* allocate(std::size_t n) {
+	    if (MemoryAccounting::enabled()) {
+	       MemoryAccounting::add(category, n * sizeof(T), objects);
+	    }
+	    return std::allocator<T>().allocate(n);
+	 }
+	 void deallocate(T* p, std::size_t n) {
+	    if (MemoryAccounting::enabled()) {
+	       MemoryAccounting::remove(category, n * sizeof(T), objects);
+	    }
+	    std::allocator<T>().deallocate(p, n);
+	 }
+
+	 template<typename U, typename... Args>
+	 void construct(U* p, Args&&... args) {
+	    ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...);
+	    if constexpr (std::is_same_v<U, std::string>) {
+	       if (MemoryAccounting::enabled() && on_heap(*p)) {
+		  MemoryAccounting::add(MemoryAccounting::event_strings,
+		     p->capacity() + 1);
+	       }
+	    }
+	 }
+	 template<typename U>
+	 void destroy(U* p) {
+	    if constexpr (std::is_same_v<U, std::string>) {
+	       if (MemoryAccounting::enabled() && on_heap(*p)) {
+		  MemoryAccounting::remove(MemoryAccounting::event_strings,
+		     p->capacity() + 1);
+	       }
+	    }
+	    p->~U();
+	 }
+
+	 template<typename U>
+	 bool operator==(
+	       const AccountingAllocator<U, category, objects>&) const {
+	    return true;
+	 }
+	 template<typename U>
+	 bool operator!=(
+	       const AccountingAllocator<U, category, objects>&) const {
+	    return false;
+	 }
+
+      private:
+	 /* short strings are kept within the string object */
+	 static bool on_heap(const std::string& s) {
+	    auto data = s.data();
+	    auto object = reinterpret_cast<const char*>(&s);
+	    return data < object || data >= object + sizeof s;
+	 }
+   };
+
+} // namespace CSP
+
+#endif
@@ -0,0 +1,125 @@
+/* 
+   Copyright (c) 2011-2024 Andreas F. Borchert
+   All rights reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining
+   a copy of this software and associated documentation files (the
+   "Software"), to deal in the Software without restriction, including
+   without limitation the rights to use, copy, modify, merge, publish,
+   distribute, sublicense, and/or sell copies of the Software, and to
+   permit persons to whom the Software is furnished to do so, subject to
+   the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+   KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+   BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+*/
+
+#ifndef CSP_MODEL_HPP
+#define CSP_MODEL_HPP
+
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "alphabet.hpp"
+#include "context.hpp"
+#include "parser.hpp"
+#include "process.hpp"
+#include "scanner.hpp"
+#include "symtable.hpp"
+
+/*
+   A model is a parsed CSP program whose process terms are shared
+   by all sessions that run on it, possibly in parallel (see
+   session.hpp). Process terms are not changed by sessions as all
+   run-time information is kept in status objects. Lazy
+   initializations of process terms are either done when the model
+   is loaded or synchronized.
+*/
+
+namespace CSP {
+
+   class Model;
+   using ModelPtr = std::shared_ptr<const Model>;
+
+   class Model: public std::enable_shared_from_this<Model> {
+      public:
+	 /* parse the given file; null is returned in case of errors
+	    which are reported on std::cerr */
+	 static ModelPtr load_file(const std::string& filename) {
+	    auto in = std::make_unique<std::ifstream>(filename);
+	    if (!*in) {
+	       std::cerr << "unable to open " << filename <<
+		  " for reading" << std::endl;
+	       return nullptr;
+	    }
+	    return load(std::move(in), filename);
+	 }
+
+	 /* parse the given source; name is used in error messages */
+	 static ModelPtr load_string(const std::string& source,
+	       const std::string& name = "string") {
+	    return load(std::make_unique<std::istringstream>(source), name);
+	 }
+
+	 Model(const Model&) = delete;
+	 Model& operator=(const Model&) = delete;
+
+	 const std::string& get_name() const {
+	    return name;
+	 }
+
+	 /* the returned process keeps the model alive */
+	 ProcessPtr get_process() const {
+	    return ProcessPtr(shared_from_this(), process.get());
+	 }
+
+	 const Alphabet& get_alphabet() const {
+	    return process->get_alphabet();
+	 }
+
+      private:
+	 std::string name;
+	 /* the objects of the parser are kept as they
+	    are still referenced by the process terms,
+	    in particular to report errors */
+	 std::unique_ptr<std::istream> in;
+	 Context context;
+	 std::unique_ptr<Scanner> scanner;
+	 std::unique_ptr<SymTable> symtab;
+	 ProcessPtr process;
+
+	 Model(const std::string& name, std::unique_ptr<std::istream> in) :
+	       name(name), in(std::move(in)) {
+	 }
+
+	 static ModelPtr load(std::unique_ptr<std::istream> in,
+	       const std::string& name) {
+	    std::shared_ptr<Model> model(new Model(name, std::move(in)));
+	    model->scanner = std::make_unique<Scanner>(model->context,
+	       *model->in, model->name);
+	    model->symtab = std::make_unique<SymTable>(model->context);
+	    parser p(model->context, model->process);
+	    if (p.parse() != 0 || model->context.get_error_count() > 0) {
+	       return nullptr;
+	    }
+	    /* construct the alphabets before the process is shared */
+	    model->process->get_alphabet();
+	    return model;
+	 }
+   };
+
+} // namespace CSP
+
+#endif
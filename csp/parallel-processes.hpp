@@ -48,14 +48,15 @@ namespace CSP {
 	    assert(process1); assert(process2);
 	 }
 	 void print(std::ostream& out) const override {
-	    process1->print(out); out << " || "; process2->print(out);
+	    print_subterm(out, process1); out << " || ";
+	    print_subterm(out, process2);
 	 }
 	 void expanded_print(std::ostream& out) const override {
-	    process1->expanded_print(out);
+	    print_subterm(out, process1, true);
 	    out << " || ";
-	    process2->expanded_print(out);
+	    print_subterm(out, process2, true);
 	 }
-	 Alphabet acceptable(StatusPtr status) const final {
+	 Alphabet internal_acceptable(StatusPtr status) const final {
 	    /* events are acceptable either
 	         if they are accepted by both, or
 		 if they do belong to the alphabet of one of the processes only
@@ -76,8 +77,15 @@ namespace CSP {
 	    StatusPtr s2;
 	    InternalStatus(StatusPtr status) :
 	       Status(status),
-	       s1(std::make_shared<Status>(status)),
-	       s2(std::make_shared<Status>(status)) {
+	       s1(make_accounted<Status>(status)),
+	       s2(make_accounted<Status>(status)) {
+	    }
+	    StatusPtr copy() const override {
+	       return make_accounted<InternalStatus>(*this);
+	    }
+	    void clone_members(Cloner& clone) override {
+	       Status::clone_members(clone);
+	       s1 = clone(s1); s2 = clone(s2);
 	    }
 	 };
 
@@ -91,7 +99,13 @@ namespace CSP {
 	    auto [p2, s2] = process2->proceed(event, s->s2);
 	    if (p1 && p2) {
 	       s->s1 = s1; s->s2 = s2;
-	       return {std::make_shared<ParallelProcesses>(p1, p2), s};
+	       auto p = make_accounted<ParallelProcesses>(p1, p2);
+	       /* the alphabet remains unchanged */
+	       auto& alphabet = get_alphabet();
+	       if (alphabet.cardinality() > 0) {
+		  p->set_alphabet(alphabet);
+	       }
+	       return {p, s};
 	    } else {
 	       return {nullptr, s};
 	    }
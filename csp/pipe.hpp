@@ -24,86 +24,258 @@
 */
 
 /*
-   Support of subordination operator P // Q,
-   see CSP 4.5
+   Support of pipes P1 >> P2 >> ... >> Pn, see CSP 4.4;
+   the stages are kept side by side where the right channel of
+   each stage is connected to the left channel of its successor;
+   all other events of a stage besides left and right are concealed
 */
 
 #ifndef CSP_PIPE_HPP
 #define CSP_PIPE_HPP
 
 #include <cassert>
+#include <cstdlib>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <tuple>
+#include <vector>
 
 #include "alphabet.hpp"
-#include "concealed-process.hpp"
-#include "context.hpp"
 #include "process.hpp"
-#include "symbol-changer.hpp"
-#include "symtable.hpp"
 
 namespace CSP {
 
    class Pipe: public Process {
       public:
-	 Pipe(Context& context, ProcessPtr p, ProcessPtr q) :
-	       context(context), p(p), q(q) {
-	    assert(p); assert(q);
+	 Pipe(ProcessPtr p, ProcessPtr q) {
+	    add_stage(p);
+	    add_stage(q);
+	 }
+	 Pipe(const std::vector<ProcessPtr>& stages) : stages(stages) {
+	    assert(stages.size() > 1);
 	 }
 	 void print(std::ostream& out) const override {
-	    p->print(out); out << " >> "; q->print(out);
+	    bool first = true;
+	    for (auto& stage: stages) {
+	       if (first) {
+		  first = false;
+	       } else {
+		  out << " >> ";
+	       }
+	       print_subterm(out, stage);
+	    }
 	 }
-	 Alphabet acceptable(StatusPtr status) const final {
-	    setup();
-	    return pipe->acceptable(status);
+	 Alphabet internal_acceptable(StatusPtr status) const final {
+	    auto s = get_owned_status<InternalStatus>(status, this);
+	    decide(s);
+	    if (s->deadlocked) {
+	       /* too bad -- we have turned into STOP */
+	       return Alphabet();
+	    }
+	    return s->visible;
 	 }
 
       private:
-	 Context& context;
-	 ProcessPtr p;
-	 ProcessPtr q;
-	 mutable ProcessPtr pipe;
-
-	 ProcessPtr conceal_except(ProcessPtr p,
-	       const std::string& left,
-	       const std::string& right) const {
-	    auto p_alpha = p->get_alphabet();
-	    auto conceal = exclude_prefix(exclude_prefix(p_alpha, left), right);
-	    if (conceal.cardinality() > 0) {
-	       return std::make_shared<ConcealedProcess>(p, conceal);
+	 std::vector<ProcessPtr> stages;
+
+	 struct InternalStatus: public Status {
+	    const Pipe* owner;
+	    /* current state of the stages and their statuses
+	       which are updated by internal moves */
+	    std::vector<ProcessPtr> stages;
+	    std::vector<StatusPtr> statuses;
+	    /* the acceptable sets of a stage remain valid
+	       until it moves */
+	    std::vector<bool> cached;
+	    std::vector<Alphabet> accepting;
+	    std::vector<Alphabet> hidden; // concealed events of a stage
+	    /* handoffs[i] are the values which can be passed
+	       from stage i to stage i + 1, given as "left.x" */
+	    std::vector<Alphabet> handoffs;
+	    bool decided;
+	    bool deadlocked;
+	    Alphabet visible; // valid if decided and not deadlocked
+
+	    InternalStatus(StatusPtr status, const Pipe* owner) :
+		  Status(status), owner(owner), stages(owner->stages),
+		  cached(stages.size(), false),
+		  accepting(stages.size()), hidden(stages.size()),
+		  handoffs(stages.size() - 1),
+		  decided(false), deadlocked(false) {
+	       for (std::size_t i = 0; i < stages.size(); ++i) {
+		  statuses.push_back(make_accounted<Status>(status));
+	       }
+	    }
+	    StatusPtr copy() const override {
+	       return make_accounted<InternalStatus>(*this);
+	    }
+	    void clone_members(Cloner& clone) override {
+	       Status::clone_members(clone);
+	       for (auto& s: statuses) {
+		  s = clone(s);
+	       }
+	    }
+	 };
+	 using InternalStatusPtr = std::shared_ptr<InternalStatus>;
+
+	 void add_stage(ProcessPtr p) {
+	    assert(p);
+	    auto pipe = std::dynamic_pointer_cast<Pipe>(p);
+	    if (pipe) {
+	       stages.insert(stages.end(),
+		  pipe->stages.begin(), pipe->stages.end());
 	    } else {
-	       return p;
+	       stages.push_back(p);
 	    }
 	 }
 
-	 void setup() const {
-	    if (!pipe) {
-	       auto mid = context.symtab().get_unique_symbol();
-	       auto map_right = std::make_shared<MapChannel>("right", mid);
-	       auto map_left = std::make_shared<MapChannel>("left", mid);
-	       auto p_mapped = conceal_except(
-		     std::make_shared<MappedProcess>(p, map_right),
-		     "left", mid);
-	       auto q_mapped = conceal_except(
-		     std::make_shared<MappedProcess>(q, map_left),
-		     mid, "right");
-	       auto pp = std::make_shared<ParallelProcesses>(p_mapped,
-		  q_mapped);
-	       auto conceal = select_prefix(pp->get_alphabet(), mid);
-	       pipe = std::make_shared<ConcealedProcess>(pp, conceal);
+	 /* replace "from.x" by "to.x" */
+	 static std::string rename(const std::string& event,
+	       const std::string& from, const std::string& to) {
+	    return to + event.substr(from.size());
+	 }
+
+	 /* recompute the acceptable sets of all stages that moved
+	    and the handoffs next to them */
+	 void update(InternalStatusPtr s) const {
+	    auto n = s->stages.size();
+	    std::vector<bool> moved(n, false);
+	    for (std::size_t i = 0; i < n; ++i) {
+	       if (s->cached[i]) continue;
+	       moved[i] = true;
+	       s->accepting[i] = s->stages[i]->acceptable(s->statuses[i]);
+	       Alphabet hidden;
+	       for (auto& event: s->accepting[i]) {
+		  if (event != "_success_" &&
+			!matches_prefix(event, "left") &&
+			!matches_prefix(event, "right")) {
+		     hidden += event;
+		  }
+	       }
+	       s->hidden[i] = hidden;
+	       s->cached[i] = true;
+	    }
+	    for (std::size_t i = 0; i + 1 < n; ++i) {
+	       if (!moved[i] && !moved[i+1]) continue;
+	       Alphabet output;
+	       for (auto& event: select_prefix(s->accepting[i], "right")) {
+		  output += rename(event, "right", "left");
+	       }
+	       s->handoffs[i] = output *
+		  select_prefix(s->accepting[i+1], "left");
 	    }
 	 }
 
+	 void move(InternalStatusPtr s, std::size_t i,
+	       const std::string& event) const {
+	    std::tie(s->stages[i], s->statuses[i]) =
+	       s->stages[i]->proceed(event, s->statuses[i]);
+	    assert(s->stages[i]);
+	    s->cached[i] = false;
+	 }
+
+	 void decide(InternalStatusPtr s) const {
+	    if (s->decided) return;
+	    /* like ConcealedProcess we proceed with randomly
+	       selected internal events until one of the selected
+	       events is visible; this is limited to 1000 attempts
+	       as this could be divergent otherwise */
+	    auto n = s->stages.size();
+	    unsigned int count = 0;
+	    while (count++ < 1000) {
+	       update(s);
+	       Alphabet visible =
+		  select_prefix(s->accepting[0], "left") +
+		  select_prefix(s->accepting[n-1], "right");
+	       bool success = true;
+	       for (std::size_t i = 0; success && i < n; ++i) {
+		  success = s->accepting[i].is_member("_success_");
+	       }
+	       if (success) visible += "_success_";
+	       std::size_t total = visible.cardinality();
+	       for (std::size_t i = 0; i < n; ++i) {
+		  total += s->hidden[i].cardinality();
+		  if (i + 1 < n) total += s->handoffs[i].cardinality();
+	       }
+	       if (total == 0) {
+		  /* deadlock */
+		  s->deadlocked = true; s->decided = true;
+		  return;
+	       }
+	       std::size_t chose = s->draw(total);
+	       if (chose < std::size_t(visible.cardinality())) {
+		  s->visible = visible; s->decided = true;
+		  return;
+	       }
+	       chose -= visible.cardinality();
+	       for (std::size_t i = 0; i < n; ++i) {
+		  std::size_t hidden = s->hidden[i].cardinality();
+		  if (chose < hidden) {
+		     move(s, i, *std::next(s->hidden[i].begin(), chose));
+		     break;
+		  }
+		  chose -= hidden;
+		  if (i + 1 < n) {
+		     std::size_t handoffs = s->handoffs[i].cardinality();
+		     if (chose < handoffs) {
+			auto event = *std::next(s->handoffs[i].begin(), chose);
+			move(s, i, rename(event, "left", "right"));
+			move(s, i + 1, event);
+			break;
+		     }
+		     chose -= handoffs;
+		  }
+	       }
+	    }
+	    /* emergency break from a possibly otherwise endless loop;
+	       the only option we have here is to turn into STOP */
+	    s->deadlocked = true; s->decided = true;
+	 }
+
 	 ActiveProcess internal_proceed(const std::string& event,
 	       StatusPtr status) final {
-	    setup();
-	    return pipe->proceed(event, status);
+	    auto s = get_owned_status<InternalStatus>(status, this);
+	    decide(s);
+	    if (s->deadlocked) {
+	       return {nullptr, s};
+	    }
+	    auto n = s->stages.size();
+	    std::size_t i;
+	    if (matches_prefix(event, "left")) {
+	       i = 0;
+	    } else if (matches_prefix(event, "right")) {
+	       i = n - 1;
+	    } else {
+	       return {nullptr, s};
+	    }
+	    /* the event may still be refused by processes running
+	       in parallel to us; hence the stage proceeds on a clone
+	       and our status remains untouched */
+	    auto [p, ps] = s->stages[i]->proceed(event,
+	       Status::clone(s->statuses[i]));
+	    if (!p) {
+	       return {nullptr, s};
+	    }
+	    /* the successor gets a status of its own */
+	    auto ns = make_accounted<InternalStatus>(*s);
+	    ns->stages[i] = p; ns->statuses[i] = ps; ns->cached[i] = false;
+	    ns->decided = false;
+	    auto successor = make_accounted<Pipe>(ns->stages);
+	    /* the alphabet remains unchanged */
+	    auto& alphabet = get_alphabet();
+	    if (alphabet.cardinality() > 0) {
+	       successor->set_alphabet(alphabet);
+	    }
+	    ns->owner = successor.get();
+	    return {successor, ns};
 	 }
 	 Alphabet internal_get_alphabet() const final {
-	    auto p_alpha = select_prefix(p->get_alphabet(), "left");
-	    auto q_alpha = select_prefix(q->get_alphabet(), "right");
-	    return p_alpha + q_alpha;
+	    auto left_alpha = select_prefix(stages.front()->get_alphabet(),
+	       "left");
+	    auto right_alpha = select_prefix(stages.back()->get_alphabet(),
+	       "right");
+	    return left_alpha + right_alpha;
 	 }
 
 	 void initialize_dependencies() const final {
@@ -113,4 +285,3 @@ namespace CSP {
 } // namespace CSP
 
 #endif
-
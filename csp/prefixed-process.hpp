@@ -55,14 +55,14 @@ namespace CSP {
 	    return event;
 	 }
 	 void print(std::ostream& out) const override {
-	    out << event << " -> "; process->print(out);
+	    out << event << " -> "; print_subterm(out, process);
 	 }
 	 void expanded_print(std::ostream& out) const override {
 	    /* add parentheses if we are at top-level,
 	       otherwise this is done by SelectingProcess */
 	    out << "("; print(out); out << ")";
 	 }
-	 Alphabet acceptable(StatusPtr status) const final {
+	 Alphabet internal_acceptable(StatusPtr status) const final {
 	    return Alphabet(event);
 	 }
 
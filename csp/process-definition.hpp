@@ -77,7 +77,7 @@ namespace CSP {
 	       out << get_name() << " = ";
 	    }
 	    if (process) {
-	       process->print(out);
+	       print_subterm(out, process);
 	    } else {
 	       out << "*undefined*";
 	    }
@@ -86,7 +86,7 @@ namespace CSP {
 	    return params;
 	 }
 
-	 Alphabet acceptable(StatusPtr status) const final {
+	 Alphabet internal_acceptable(StatusPtr status) const final {
 	    assert(process);
 	    return process->acceptable(status);
 	 }
@@ -31,9 +31,12 @@
 #ifndef CSP_PROCESS_REFERENCE_HPP
 #define CSP_PROCESS_REFERENCE_HPP
 
+#include <cassert>
 #include <cstdlib>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -95,20 +98,22 @@ namespace CSP {
 	    if (p) return true;
 	    auto pdef = context.symtab().lookup<ProcessDefinition>(get_name());
 	    if (!pdef) {
-	       p = context.symtab().lookup<NamedProcess>(get_name());
+	       p = context.symtab().lookup<NamedProcess>(get_name()).get();
 	       if (!p) return false;
 	       if (actual) {
 		  yyerror(loc, context, "reference of process '%s' "
 		     "does not match its definition", get_name());
 	       }
-	    } else if (!just_reference) {
-	       formal = pdef->get_params();
-	       if (!formal != !actual ||
-		     (formal && formal->size() != actual->size())) {
-		  yyerror(loc, context, "reference of process '%s' "
-		     "does not match its definition", get_name());
+	    } else {
+	       if (!just_reference) {
+		  formal = pdef->get_params();
+		  if (!formal != !actual ||
+			(formal && formal->size() != actual->size())) {
+		     yyerror(loc, context, "reference of process '%s' "
+			"does not match its definition", get_name());
+		  }
 	       }
-	       p = pdef;
+	       p = pdef.get();
 	    }
 	    for (auto c: channels) {
 	       p->add_channel(c);
@@ -125,7 +130,7 @@ namespace CSP {
 	    }
 	 }
 
-	 Alphabet acceptable(StatusPtr status) const final {
+	 Alphabet internal_acceptable(StatusPtr status) const final {
 	    if (!get_alphabet()) {
 	       /* if our alphabet is empty, we simply return
 		  the empty set; this test avoids an endless
@@ -136,9 +141,7 @@ namespace CSP {
 	    }
 	    if (!p) resolve();
 	    if (p) {
-	       auto s = std::make_shared<Status>(status);
-	       setup_bindings(s);
-	       return p->acceptable(s);
+	       return p->acceptable(bind(status));
 	    } else {
 	       return Alphabet();
 	    }
@@ -155,33 +158,92 @@ namespace CSP {
       private:
 	 const location loc;
 	 Context& context;
-	 mutable ProcessPtr p;
+	 /* not owned as recursive references would otherwise
+	    form cycles; named processes are kept alive by the
+	    symbol table or by their enclosing process terms */
+	 mutable Process* p = nullptr;
 	 ParametersPtr actual;
 	 std::vector<bool> bound;
 	 mutable ConstParametersPtr formal;
 	 mutable std::deque<ChannelPtr> channels;
 	 bool just_reference = false; // just referencing, not executing
 
-	 void setup_bindings(StatusPtr status) const {
-	    if (actual) {
-	       for (std::size_t i = 0; i < actual->size(); ++i) {
-		  auto param = actual->at(i);
-		  if (bound[i]) {
-		     auto id = status->lookup<Identifier>(param);
-		     param = id->get_name();
-		  }
-		  status->set(formal->at(i),
-		     std::make_shared<Identifier>(param));
+	 /* scopes with the bindings of the formal parameters, one for
+	    each tuple of actual values; as scopes are no longer
+	    changed once they are set up, they are shared by all
+	    invocations with the same values; the table is bounded
+	    as parameters may run through arbitrarily many values */
+	 static constexpr std::size_t max_instances = 1024;
+	 mutable std::mutex instances_mutex;
+	 mutable std::map<std::vector<std::string>, ScopePtr> instances;
+
+	 /* the status with the bindings of the parameters is kept
+	    between subsequent invocations of acceptable and proceed
+	    such that decisions taken by p in its acceptable method
+	    are not lost; it is kept per reference, see
+	    get_owned_status */
+	 struct ReferenceStatus: public Status {
+	    const ProcessReference* owner;
+	    StatusPtr bound;
+
+	    /* the right side of a process definition sees
+	       nothing but its parameters, hence we do not need
+	       to keep the scopes of the caller; otherwise
+	       they would pile up with each recursive invocation */
+	    ReferenceStatus(StatusPtr status, const ProcessReference* owner) :
+		  Status(status), owner(owner),
+		  bound(Status::fresh(status, owner->instantiate(status))) {
+	    }
+	    StatusPtr copy() const override {
+	       return make_accounted<ReferenceStatus>(*this);
+	    }
+	    void clone_members(Cloner& clone) override {
+	       Status::clone_members(clone);
+	       bound = clone(bound);
+	    }
+	 };
+
+	 /* return the status to be passed to p */
+	 StatusPtr bind(StatusPtr status) const {
+	    if (formal && actual) {
+	       return get_owned_status<ReferenceStatus>(status, this)->bound;
+	    } else {
+	       /* nothing to bind */
+	       return status;
+	    }
+	 }
+
+	 /* return the scope binding the formal parameters
+	    to the actual values seen by the caller */
+	 ScopePtr instantiate(StatusPtr caller) const {
+	    std::vector<std::string> values(actual->size());
+	    for (std::size_t i = 0; i < actual->size(); ++i) {
+	       if (bound[i]) {
+		  values[i] = caller->lookup<Identifier>(actual->at(i))->
+		     get_name();
+	       } else {
+		  values[i] = actual->at(i);
 	       }
 	    }
+	    std::lock_guard<std::mutex> lock(instances_mutex);
+	    auto it = instances.find(values);
+	    if (it != instances.end()) return it->second;
+	    auto scope = make_accounted<Scope>();
+	    for (std::size_t i = 0; i < values.size(); ++i) {
+	       bool ok = scope->insert(formal->at(i),
+		  std::make_shared<Identifier>(values[i]));
+	       assert(ok);
+	    }
+	    if (instances.size() < max_instances) {
+	       instances.emplace(std::move(values), scope);
+	    }
+	    return scope;
 	 }
 
 	 ActiveProcess internal_proceed(const std::string& event,
 	       StatusPtr status) final {
 	    if (p) {
-	       auto s = std::make_shared<Status>(status);
-	       setup_bindings(s);
-	       return p->proceed(event, s);
+	       return p->proceed(event, bind(status));
 	    } else {
 	       return {nullptr, status};
 	    }
@@ -201,7 +263,7 @@ namespace CSP {
 	    }
 	    p->add_dependant(std::dynamic_pointer_cast<const Process>(
 	       Process::shared_from_this()));
-	    add_dependant(p);
+	    add_dependant(p->shared_from_this());
 	 }
    };
 
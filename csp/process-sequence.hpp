@@ -24,7 +24,9 @@
 */
 
 /*
-   Sequence of processes, i.e. processes of the form P1; P2
+   Sequence of processes, i.e. processes of the form P1; P2;
+   nested sequences are flattened into a stack of continuations
+   which is evaluated iteratively
 */
 
 #ifndef CSP_PROCESS_SEQUENCE_HPP
@@ -41,43 +43,100 @@
 namespace CSP {
 
    class ProcessSequence: public Process {
+      private:
+	 /* the continuations are kept in a singly linked list
+	    whose tails are shared among the successors */
+	 struct Continuation;
+	 using ContinuationPtr = std::shared_ptr<const Continuation>;
+	 struct Continuation {
+	    Continuation(ProcessPtr process, ContinuationPtr next) :
+		  process(process), next(next) {
+	    }
+	    const ProcessPtr process;
+	    const ContinuationPtr next;
+	 };
+
       public:
-	 ProcessSequence(ProcessPtr p, ProcessPtr q) :
-	       process1(p), process2(q) {
-	    assert(process1);
-	    assert(process2);
+	 ProcessSequence(ProcessPtr p, ProcessPtr q) {
+	    assert(p);
+	    assert(q);
+	    auto seq = std::dynamic_pointer_cast<ProcessSequence>(q);
+	    if (seq) {
+	       processes = push(p, seq->processes);
+	    } else {
+	       processes = push(p, std::make_shared<Continuation>(q, nullptr));
+	    }
+	 }
+	 ProcessSequence(ContinuationPtr processes) : processes(processes) {
+	    assert(processes && processes->next);
 	 }
 	 void print(std::ostream& out) const override {
-	    process1->print(out); out << "; "; process2->print(out);
+	    for (auto c = processes; c; c = c->next) {
+	       print_subterm(out, c->process);
+	       if (c->next) out << "; ";
+	    }
 	 }
-	 Alphabet acceptable(StatusPtr status) const final {
-	    if (process1->accepts_success(status)) {
-	       return process2->acceptable(status);
+	 Alphabet internal_acceptable(StatusPtr status) const final {
+	    return current(status)->process->acceptable(status);
+	 }
+
+      private:
+	 ContinuationPtr processes; // at least two of them
+
+	 /* return the stack of continuations with p on top;
+	    sequences are not nested but flattened */
+	 static ContinuationPtr push(ProcessPtr p, ContinuationPtr next) {
+	    auto seq = std::dynamic_pointer_cast<ProcessSequence>(p);
+	    if (seq) {
+	       return append(seq->processes, next);
 	    } else {
-	       return process1->acceptable(status);
+	       return std::make_shared<Continuation>(p, next);
 	    }
 	 }
+	 static ContinuationPtr append(ContinuationPtr c,
+	       ContinuationPtr next) {
+	    if (!c) return next;
+	    return std::make_shared<Continuation>(c->process,
+	       append(c->next, next));
+	 }
 
-      private:
-	 ProcessPtr process1;
-	 ProcessPtr process2;
+	 /* skip all processes which have completed already */
+	 ContinuationPtr current(StatusPtr status) const {
+	    auto c = processes;
+	    while (c->next && c->process->accepts_success(status)) {
+	       c = c->next;
+	    }
+	    return c;
+	 }
 
 	 ActiveProcess internal_proceed(const std::string& event,
 	       StatusPtr status) final {
-	    if (process1->accepts_success(status)) {
-	       return process2->proceed(event, status);
-	    } else {
-	       auto [p, s] = process1->proceed(event, status);
-	       return {std::make_shared<ProcessSequence>(p, process2), s};
+	    auto c = current(status);
+	    auto [p, s] = c->process->proceed(event, status);
+	    if (!p || !c->next) return {p, s};
+	    /* the completed processes before c are dropped */
+	    auto successor = make_accounted<ProcessSequence>(
+	       push(p, c->next));
+	    /* the alphabet remains unchanged; this saves us
+	       from registering the successor as dependant */
+	    auto& alphabet = get_alphabet();
+	    if (alphabet.cardinality() > 0) {
+	       successor->set_alphabet(alphabet);
 	    }
+	    return {successor, s};
 	 }
 	 Alphabet internal_get_alphabet() const final {
-	    return process1->get_alphabet() + process2->get_alphabet();
+	    Alphabet alphabet;
+	    for (auto c = processes; c; c = c->next) {
+	       alphabet = alphabet + c->process->get_alphabet();
+	    }
+	    return alphabet;
 	 }
 	 void initialize_dependencies() const final {
 	    auto me = shared_from_this();
-	    process1->add_dependant(me);
-	    process2->add_dependant(me);
+	    for (auto c = processes; c; c = c->next) {
+	       c->process->add_dependant(me);
+	    }
 	 }
    };
 
@@ -26,12 +26,22 @@
 #ifndef CSP_PROCESS_HPP
 #define CSP_PROCESS_HPP
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
 #include <deque>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <queue>
 #include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 /* we need to declare these first
    as these types are required by some of the headers below */
@@ -44,6 +54,9 @@ namespace CSP {
 
 #include "alphabet.hpp"
 #include "channel.hpp"
+#include "coverage.hpp"
+#include "instrumentation.hpp"
+#include "memory-accounting.hpp"
 #include "object.hpp"
 #include "status.hpp"
 #include "uniformint.hpp"
@@ -55,10 +68,15 @@ namespace CSP {
    /*
       Instances of this class represent CSP processes.
    */
-   class Process: public Object, public std::enable_shared_from_this<Process> {
+   class Process: public Object, public std::enable_shared_from_this<Process>,
+	 public Accounted<MemoryAccounting::processes> {
       public:
 	 // default constructor
-	 Process() {}
+	 Process() {
+	    if (Instrumentation::enabled()) {
+	       Instrumentation::count_node();
+	    }
+	 }
 
 	 /* attempts to engage in the given event and
 	    returns a process which accepted that event;
@@ -69,7 +87,12 @@ namespace CSP {
 	    if (get_alphabet().is_member(event)) {
 	       /* use internal polymorphic function
 	          to process this event */
-	       return internal_proceed(event, status);
+	       if (Instrumentation::enabled()) {
+		  Instrumentation::Frame frame(typeid(*this),
+		     Instrumentation::Frame::proceed);
+		  return covered_proceed(event, status);
+	       }
+	       return covered_proceed(event, status);
 	    } else {
 	       /* if it is not in our alphabet
 		  we are not interested in it */
@@ -80,7 +103,14 @@ namespace CSP {
 	 /* retrieve the set of symbols which would be
 	    accepted next by this process;
 	    the empty set is returned in case of STOP */
-	 virtual Alphabet acceptable(StatusPtr status) const = 0;
+	 Alphabet acceptable(StatusPtr status) const {
+	    if (Instrumentation::enabled()) {
+	       Instrumentation::Frame frame(typeid(*this),
+		  Instrumentation::Frame::acceptable);
+	       return internal_acceptable(status);
+	    }
+	    return internal_acceptable(status);
+	 }
 
 	 /* returns true iff success is accepted,
 	    i.e. in case of a SKIP process */
@@ -93,20 +123,15 @@ namespace CSP {
 	    derived from the set of mutual recursive equations
 	    defining it */
 	 const Alphabet& get_alphabet() const {
-	    if (!dependencies_initialized) {
-	       dependencies_initialized = true;
-	       initialize_dependencies();
+	    if (alphabet_ready.load(std::memory_order_acquire)) {
+	       return alphabet;
 	    }
+	    /* processes may be shared among multiple threads,
+	       hence the lazy construction of alphabets
+	       is serialized */
+	    std::lock_guard<std::recursive_mutex> lock(alphabet_mutex());
 	    if (!alphabet_initialized) {
-	       alphabet_initialized = true;
-	       for (auto c: channels) {
-		  alphabet += get_channel_alphabet(c);
-	       }
-	       /* do not propagate implicitly success as member
-		  of the alphabet */
-	       propagate_alphabet(internal_get_alphabet() -
-		  Alphabet("_success_"));
-	       alphabet = map_alphabet(alphabet);
+	       infer_alphabets();
 	    }
 	    return alphabet;
 	 }
@@ -121,18 +146,32 @@ namespace CSP {
 	    alphabet = new_alphabet;
 	    alphabet_fixed = true;
 	    alphabet_initialized = true;
+	    /* nothing left to be done by get_alphabet */
+	    dependencies_initialized = true;
+	    alphabet_ready.store(true, std::memory_order_release);
 	 }
 
 	 /* add a process to the list of dependants whose
 	    alphabet depends on this process */
 	 void add_dependant(ConstProcessPtr p) const {
+	    prune(dependants, dependants_limit);
 	    dependants.push_back(p);
+	    prune(p->dependencies, p->dependencies_limit);
+	    p->dependencies.push_back(weak_from_this());
 	 }
 
 	 virtual void add_channel(ChannelPtr c) const {
 	    channels.push_back(c);
 	 }
 
+	 /* see Coverage */
+	 void set_coverage_point(Coverage::Point point) {
+	    coverage_point = point;
+	 }
+	 Coverage::Point get_coverage_point() const {
+	    return coverage_point;
+	 }
+
       private:
 	 /* internal implementation of proceed
 	    which no longer needs to check if event belongs to
@@ -140,6 +179,19 @@ namespace CSP {
 	 virtual ActiveProcess internal_proceed(const std::string& event,
 	    StatusPtr status) = 0;
 
+	 ActiveProcess covered_proceed(const std::string& event,
+	       StatusPtr status) {
+	    if (coverage_point == Coverage::none) {
+	       return internal_proceed(event, status);
+	    }
+	    auto result = internal_proceed(event, status);
+	    if (result.first) Coverage::hit(coverage_point, event);
+	    return result;
+	 }
+
+	 /* internal implementation of acceptable */
+	 virtual Alphabet internal_acceptable(StatusPtr status) const = 0;
+
 	 /* construct initial alphabet */
 	 virtual Alphabet internal_get_alphabet() const = 0;
 
@@ -147,9 +199,36 @@ namespace CSP {
 	 bool alphabet_fixed = false; // changed only by set_alphabet
 	 mutable bool alphabet_initialized = false;
 	 mutable bool dependencies_initialized = false;
-	 mutable std::deque<ConstProcessPtr> dependants;
+	 mutable std::atomic<bool> alphabet_ready{false};
+	 /* dependency edges in both directions; they do not own
+	    the processes as they would otherwise form cycles:
+	    process terms are owned by their enclosing terms,
+	    and process definitions by the symbol table */
+	 using Edges = std::deque<std::weak_ptr<const Process>>;
+	 mutable Edges dependants;
+	 mutable Edges dependencies;
+	 mutable std::size_t dependants_limit = min_prune_limit;
+	 mutable std::size_t dependencies_limit = min_prune_limit;
 	 // channels this process depends on
 	 mutable std::deque<ChannelPtr> channels;
+	 Coverage::Point coverage_point = Coverage::none;
+
+	 /* drop edges of processes that no longer exist,
+	    amortized over the insertions */
+	 static constexpr std::size_t min_prune_limit = 64;
+	 static void prune(Edges& edges, std::size_t& limit) {
+	    if (edges.size() < limit) return;
+	    edges.erase(std::remove_if(edges.begin(), edges.end(),
+	       [](const std::weak_ptr<const Process>& p) {
+		  return p.expired();
+	       }), edges.end());
+	    limit = std::max(min_prune_limit, 2 * edges.size());
+	 }
+
+	 static std::recursive_mutex& alphabet_mutex() {
+	    static std::recursive_mutex mutex;
+	    return mutex;
+	 }
 
 	 virtual Alphabet get_channel_alphabet(ChannelPtr c) const {
 	    return c->get_alphabet();
@@ -159,11 +238,180 @@ namespace CSP {
 	    this is suppressed if the alphabet was explicitly
 	    set before */
 	 void propagate_alphabet(const Alphabet& new_alphabet) const {
-	    if (!alphabet_fixed) {
-	       if (new_alphabet - alphabet) {
-		  alphabet = alphabet + new_alphabet;
-		  for (auto& d: dependants) {
-		     d->propagate_alphabet(map_alphabet(alphabet));
+	    std::vector<std::pair<ConstProcessPtr, Alphabet>> worklist{
+	       {shared_from_this(), new_alphabet}
+	    };
+	    while (!worklist.empty()) {
+	       auto [p, a] = worklist.back(); worklist.pop_back();
+	       if (p->alphabet_fixed || p->alphabet >= a) continue;
+	       p->alphabet.unite(a);
+	       auto mapped = p->map_alphabet(p->alphabet);
+	       for (auto& dependant: p->dependants) {
+		  auto d = dependant.lock();
+		  if (d) worklist.emplace_back(d, mapped);
+	       }
+	    }
+	 }
+
+	 /* infer the alphabets of this process and all processes
+	    which are connected to it by dependencies and whose
+	    alphabets have not been initialized yet:
+	     - the dependency graph is explored first,
+	     - its strongly connected components are determined
+	       where processes which map their alphabet
+	       cut the components,
+	     - and the alphabets are computed as fixpoint by
+	       a worklist which visits the components in
+	       topological order and updates a component only
+	       if it gets events it does not have yet.
+	    All processes of a component share their alphabet. */
+	 void infer_alphabets() const {
+	    std::vector<ConstProcessPtr> nodes;
+	    std::unordered_map<const Process*, std::size_t> index;
+	    auto visit = [&](ConstProcessPtr p) {
+	       if (p->alphabet_initialized) return;
+	       /* in nested inferences, the processes of
+		  the enclosing inference are considered
+		  as initialized */
+	       p->alphabet_initialized = true;
+	       index[p.get()] = nodes.size();
+	       nodes.push_back(p);
+	    };
+	    visit(shared_from_this());
+	    for (std::size_t i = 0; i < nodes.size(); ++i) {
+	       auto p = nodes[i];
+	       if (!p->dependencies_initialized) {
+		  p->dependencies_initialized = true;
+		  p->initialize_dependencies();
+	       }
+	       for (auto& edges: {&p->dependants, &p->dependencies}) {
+		  for (auto& edge: *edges) {
+		     auto d = edge.lock();
+		     if (d) visit(d);
+		  }
+	       }
+	    }
+	    auto n = nodes.size();
+
+	    /* initial alphabets; note that internal_get_alphabet
+	       may run nested inferences which propagate
+	       events to our processes */
+	    std::vector<Alphabet> values(n);
+	    for (std::size_t i = 0; i < n; ++i) {
+	       auto& p = nodes[i];
+	       for (auto c: p->channels) {
+		  values[i] += p->get_channel_alphabet(c);
+	       }
+	       /* do not propagate implicitly success as member
+		  of the alphabet */
+	       values[i] = values[i] +
+		  (p->internal_get_alphabet() - Alphabet("_success_"));
+	    }
+	    std::vector<std::vector<std::size_t>> successors(n);
+	    for (std::size_t i = 0; i < n; ++i) {
+	       if (!(values[i] >= nodes[i]->alphabet)) {
+		  values[i].unite(nodes[i]->alphabet);
+	       }
+	       for (auto& d: nodes[i]->dependants) {
+		  auto it = index.find(d.lock().get());
+		  if (it != index.end()) {
+		     successors[i].push_back(it->second);
+		  }
+	       }
+	    }
+
+	    /* strongly connected components by Tarjan's algorithm
+	       which delivers them in reverse topological order */
+	    constexpr std::size_t none = ~std::size_t(0);
+	    std::vector<std::size_t> order(n, none), lowlink(n);
+	    std::vector<std::size_t> component(n, none);
+	    std::vector<std::vector<std::size_t>> members;
+	    std::vector<std::size_t> stack;
+	    std::vector<std::pair<std::size_t, std::size_t>> frames;
+	    std::size_t counter = 0;
+	    auto enter = [&](std::size_t v) {
+	       order[v] = lowlink[v] = counter++;
+	       stack.push_back(v);
+	       frames.emplace_back(v, 0);
+	    };
+	    for (std::size_t root = 0; root < n; ++root) {
+	       if (order[root] != none) continue;
+	       enter(root);
+	       while (!frames.empty()) {
+		  auto [v, edge] = frames.back();
+		  if (!nodes[v]->maps_alphabet() &&
+			edge < successors[v].size()) {
+		     ++frames.back().second;
+		     auto w = successors[v][edge];
+		     if (order[w] == none) {
+			enter(w);
+		     } else if (component[w] == none) {
+			lowlink[v] = std::min(lowlink[v], order[w]);
+		     }
+		     continue;
+		  }
+		  frames.pop_back();
+		  if (!frames.empty()) {
+		     auto u = frames.back().first;
+		     lowlink[u] = std::min(lowlink[u], lowlink[v]);
+		  }
+		  if (lowlink[v] != order[v]) continue;
+		  std::vector<std::size_t> scc;
+		  std::size_t w;
+		  do {
+		     w = stack.back(); stack.pop_back();
+		     component[w] = members.size();
+		     scc.push_back(w);
+		  } while (w != v);
+		  members.push_back(std::move(scc));
+	       }
+	    }
+
+	    /* fixpoint; components with higher numbers come first */
+	    std::vector<Alphabet> alphabets(members.size());
+	    for (std::size_t i = 0; i < n; ++i) {
+	       auto& a = alphabets[component[i]];
+	       if (!(a >= values[i])) {
+		  a.unite(values[i]);
+	       }
+	    }
+	    std::priority_queue<std::size_t> worklist;
+	    std::vector<bool> queued(members.size(), true);
+	    for (std::size_t c = 0; c < members.size(); ++c) {
+	       worklist.push(c);
+	    }
+	    while (!worklist.empty()) {
+	       auto c = worklist.top(); worklist.pop();
+	       queued[c] = false;
+	       for (auto v: members[c]) {
+		  bool maps = nodes[v]->maps_alphabet();
+		  Alphabet a = maps? nodes[v]->map_alphabet(alphabets[c]):
+		     alphabets[c];
+		  for (auto w: successors[v]) {
+		     auto cw = component[w];
+		     if (cw == c && !maps) continue;
+		     if (!(alphabets[cw] >= a)) {
+			alphabets[cw].unite(a);
+			if (!queued[cw]) {
+			   queued[cw] = true; worklist.push(cw);
+			}
+		     }
+		  }
+	       }
+	    }
+
+	    for (std::size_t i = 0; i < n; ++i) {
+	       auto& p = nodes[i];
+	       p->alphabet = p->map_alphabet(alphabets[component[i]]);
+	       p->alphabet_ready.store(true, std::memory_order_release);
+	    }
+	    /* dependants outside of this inference have
+	       already been initialized */
+	    for (auto& p: nodes) {
+	       for (auto& dependant: p->dependants) {
+		  auto d = dependant.lock();
+		  if (d && index.find(d.get()) == index.end()) {
+		     d->propagate_alphabet(p->alphabet);
 		  }
 	       }
 	    }
@@ -172,11 +420,105 @@ namespace CSP {
 	 virtual Alphabet map_alphabet(const Alphabet& alphabet) const {
 	    return alphabet;
 	 }
+	 /* true if map_alphabet is not the identity */
+	 virtual bool maps_alphabet() const {
+	    return false;
+	 }
 
 	 virtual void initialize_dependencies() const {
 	 }
    };
 
+   /*
+      Process terms are printed in a restricted form if a
+      PrintControl object is attached to the output stream:
+       - subterms beyond the maximal depth are printed as "..."
+       - in diff mode, subterms which were part of the previously
+	 printed process term are printed as "[=]"
+      Hence, the effort of printing a process term after each
+      event is proportional to the change and not to the
+      size of the term.
+   */
+   class PrintControl {
+      public:
+	 /* max_depth = 0: no depth limit */
+	 PrintControl(unsigned int max_depth, bool diff) :
+	       max_depth(max_depth), diff(diff) {
+	 }
+
+	 /* print the process term of the current step */
+	 void print(std::ostream& out, ConstProcessPtr process) {
+	    attach(out, this);
+	    print_subterm(out, process, true);
+	    attach(out, nullptr);
+	    /* the current term becomes the previous term */
+	    std::swap(previous, current); current.clear();
+	    std::swap(previous_terms, current_terms); current_terms.clear();
+	 }
+
+	 void print_subterm(std::ostream& out, const ConstProcessPtr& process,
+	       bool expanded) {
+	    if (max_depth > 0 && depth >= max_depth) {
+	       out << "..."; return;
+	    }
+	    if (diff) {
+	       if (current.insert(process.get()).second) {
+		  /* keep it alive such that its address is not reused */
+		  current_terms.push_back(process);
+	       }
+	       if (previous.find(process.get()) != previous.end()) {
+		  out << "[=]"; return;
+	       }
+	    }
+	    ++depth;
+	    if (expanded) {
+	       process->expanded_print(out);
+	    } else {
+	       process->print(out);
+	    }
+	    --depth;
+	 }
+
+	 /* return the print control attached to out, if any */
+	 static PrintControl* get(std::ostream& out) {
+	    return static_cast<PrintControl*>(out.pword(index()));
+	 }
+
+	 /* attach the print control of one stream to another stream */
+	 static void inherit(std::ostream& to, std::ostream& from) {
+	    attach(to, get(from));
+	 }
+
+      private:
+	 unsigned int max_depth;
+	 bool diff;
+	 unsigned int depth = 0;
+	 std::unordered_set<const Process*> previous, current;
+	 std::vector<ConstProcessPtr> previous_terms, current_terms;
+
+	 static int index() {
+	    static const int i = std::ios_base::xalloc();
+	    return i;
+	 }
+
+	 static void attach(std::ostream& out, PrintControl* control) {
+	    out.pword(index()) = control;
+	 }
+   };
+
+   /* to be used by print implementations for their subterms */
+   inline void print_subterm(std::ostream& out, const ConstProcessPtr& process,
+	 bool expanded = false) {
+      auto control = PrintControl::get(out);
+      if (control) {
+	 control->print_subterm(out, process, expanded);
+      } else if (expanded) {
+	 process->expanded_print(out);
+      } else {
+	 process->print(out);
+      }
+   }
+
    inline std::ostream& operator<<(std::ostream& out, ProcessPtr p) {
       p->expanded_print(out); return out;
    }
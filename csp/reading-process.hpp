@@ -59,8 +59,8 @@ namespace CSP {
 	 }
 	 void print(std::ostream& out) const override {
 	    if (process) {
-	       out << channel->get_name() <<
-		  "?" << varname << " -> " << process;
+	       out << channel->get_name() << "?" << varname << " -> ";
+	       print_subterm(out, process, true);
 	    } else {
 	       out << channel->get_name() <<
 		  "?" << varname << " -> ...";
@@ -71,9 +71,10 @@ namespace CSP {
 	       otherwise this is done by SelectingProcess */
 	    out << "("; print(out); out << ")";
 	 }
-	 Alphabet acceptable(StatusPtr status) const final {
+	 Alphabet internal_acceptable(StatusPtr status) const final {
 	    std::string prefix = channel->get_name() + ".";
 	    auto prefix_len = prefix.length();
+	    Alphabet a;
 	    for (auto event: get_alphabet()) {
 	       if (event.substr(0, prefix_len) == prefix) {
 		  a += event;
@@ -86,7 +87,6 @@ namespace CSP {
 	 ChannelPtr channel;
 	 const std::string varname;
 	 ProcessPtr process;
-	 mutable Alphabet a; // return value for acceptable
 
 	 ActiveProcess internal_proceed(const std::string& next_event,
 	       StatusPtr status) final {
@@ -96,9 +96,8 @@ namespace CSP {
 	       return {nullptr, status};
 	    }
 	    auto message = next_event.substr(prefix_len);
-	    status = std::make_shared<Status>(status);
-	    status->set(varname, std::make_shared<Identifier>(message));
-	    return {process, status};
+	    return {process, Status::bind(status, varname,
+	       std::make_shared<Identifier>(message))};
 	 }
 	 Alphabet internal_get_alphabet() const final {
 	    /* the rest of the alphabet is constructed through
@@ -62,7 +62,7 @@ namespace CSP {
 	       out << ":" << get_alphabet();
 	    }
 	    if (process) {
-	       out << "."; process->print(out);
+	       out << "."; print_subterm(out, process);
 	    }
 	 }
 
@@ -71,7 +71,7 @@ namespace CSP {
 	    process = p;
 	 }
 
-	 Alphabet acceptable(StatusPtr status) const final {
+	 Alphabet internal_acceptable(StatusPtr status) const final {
 	    return process->acceptable(status);
 	 }
 
@@ -51,7 +51,7 @@ namespace CSP {
 	 void print(std::ostream& out) const override {
 	    out << "RUN " << get_alphabet();
 	 }
-	 Alphabet acceptable(StatusPtr status) const final {
+	 Alphabet internal_acceptable(StatusPtr status) const final {
 	    return get_alphabet();
 	 }
       private:
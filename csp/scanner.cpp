@@ -23,6 +23,9 @@
    SOFTWARE.
 */
 
+#include <cstring>
+#include <string_view>
+
 #include "error.hpp"
 #include "identifier.hpp"
 #include "object.hpp"
@@ -34,34 +37,99 @@ namespace CSP {
 
 // private functions =========================================================
 
-bool is_letter(char ch) {
-   return ((ch >= 'a') && (ch <= 'z')) ||
-      ((ch >= 'A') && (ch <= 'Z')) || ch == '_';
-}
+/* character classes, looked up by table */
+enum CharClass: unsigned char {
+   LOWER = 1, UPPER = 2, UNDERSCORE = 4, DIGIT = 8, WHITESPACE = 16,
+   LETTER = LOWER | UPPER | UNDERSCORE,
+   IDENT = LETTER | DIGIT,
+};
 
-bool is_lower(char ch) {
-   return (ch >= 'a') && (ch <= 'z');
-}
-
-bool is_upper(char ch) {
-   return (ch >= 'A') && (ch <= 'Z');
-}
+struct CharClassTable {
+   unsigned char classes[256] = {};
+   constexpr CharClassTable() {
+      for (int ch = 'a'; ch <= 'z'; ++ch) classes[ch] = LOWER;
+      for (int ch = 'A'; ch <= 'Z'; ++ch) classes[ch] = UPPER;
+      for (int ch = '0'; ch <= '9'; ++ch) classes[ch] = DIGIT;
+      classes['_'] = UNDERSCORE;
+      for (unsigned char ch: {' ', '\t', '\r', '\n', '\f', '\v'}) {
+	 classes[ch] = WHITESPACE;
+      }
+   }
+};
+constexpr CharClassTable char_classes;
 
-bool is_digit(char ch) {
-   return (ch >= '0') && (ch <= '9');
+inline bool is_a(unsigned char ch, unsigned char cls) {
+   return char_classes.classes[ch] & cls;
 }
 
-bool is_whitespace(char ch) {
-   return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' ||
-      ch == '\f' || ch == '\v';
+/* keywords are recognized by a perfect hash which
+   has been found by trying small coefficients */
+struct Keyword {
+   std::string_view name;
+   int token;
+};
+constexpr std::size_t keyword_table_size = 16;
+constexpr std::size_t keyword_hash(std::string_view s) {
+   return (s.size() + 2 * (unsigned char) s[0] +
+      6 * (unsigned char) s[1]) % keyword_table_size;
 }
+struct KeywordTable {
+   Keyword keywords[keyword_table_size] = {};
+   constexpr KeywordTable() {
+      Keyword list[] = {
+	 {"CHAOS", parser::token::CHAOS},
+	 {"RUN", parser::token::RUN},
+	 {"SKIP", parser::token::SKIP},
+	 {"STOP", parser::token::STOP},
+	 {"alpha", parser::token::ALPHA},
+	 {"mu", parser::token::MU},
+	 {"string", parser::token::STRING},
+	 {"integer", parser::token::INTEGER},
+	 {"div", parser::token::DIV},
+	 {"mod", parser::token::MOD},
+      };
+      for (auto& keyword: list) {
+	 keywords[keyword_hash(keyword.name)] = keyword;
+      }
+   }
+   /* returns 0 if s is not a keyword */
+   constexpr int lookup(std::string_view s) const {
+      if (s.size() < 2) return 0;
+      auto& keyword = keywords[keyword_hash(s)];
+      return keyword.name == s? keyword.token: 0;
+   }
+};
+constexpr KeywordTable keyword_table;
+/* the hash must be free of collisions */
+static_assert(keyword_table.lookup("CHAOS") == parser::token::CHAOS &&
+   keyword_table.lookup("RUN") == parser::token::RUN &&
+   keyword_table.lookup("SKIP") == parser::token::SKIP &&
+   keyword_table.lookup("STOP") == parser::token::STOP &&
+   keyword_table.lookup("alpha") == parser::token::ALPHA &&
+   keyword_table.lookup("mu") == parser::token::MU &&
+   keyword_table.lookup("string") == parser::token::STRING &&
+   keyword_table.lookup("integer") == parser::token::INTEGER &&
+   keyword_table.lookup("div") == parser::token::DIV &&
+   keyword_table.lookup("mod") == parser::token::MOD);
 
 // constructor ===============================================================
 
 Scanner::Scanner(Context& context, std::istream& in,
 	 const std::string& input_name) :
-      context(context), in(in), input_name(input_name) {
+      context(context), input_name(input_name) {
    context.set_scanner(*this);
+   /* read the input in blocks at once */
+   char buf[65536];
+   while (in.read(buf, sizeof buf) || in.gcount() > 0) {
+      source.append(buf, in.gcount());
+   }
+   line_starts.push_back(0);
+   for (const char* cp = source.data();
+	 (cp = static_cast<const char*>(std::memchr(cp, '\n',
+	    source.data() + source.size() - cp)));) {
+      ++cp;
+      line_starts.push_back(cp - source.data());
+   }
    // unfortunately pos insists on a non-const pointer to std::string
    pos.initialize(&this->input_name);
    nextch();
@@ -77,55 +145,42 @@ restart:
    for(;;) {
       if (eof) {
 	 break;
-      } else if (is_whitespace(ch)) {
+      } else if (is_a(ch, WHITESPACE)) {
 	 nextch();
       } else {
 	 break;
       }
    }
    tokenloc.begin = oldpos;
-   if (is_letter(ch) || is_digit(ch)) {
-      tokenstr = std::make_unique<std::string>();
-      if (is_lower(ch) || is_digit(ch)) {
+   if (is_a(ch, IDENT)) {
+      if (is_a(ch, LOWER | DIGIT)) {
 	 token = parser::token::LCIDENT;
       } else {
 	 token = parser::token::UCIDENT;
       }
-      while (is_letter(ch) || is_digit(ch)) {
+      auto start = chpos;
+      while (is_a(ch, IDENT)) {
 	 nextch();
       }
-      if (*tokenstr == "CHAOS") {
-	 token = parser::token::CHAOS;
-      } else if (*tokenstr == "RUN") {
-	 token = parser::token::RUN;
-      } else if (*tokenstr == "SKIP") {
-	 token = parser::token::SKIP;
-      } else if (*tokenstr == "STOP") {
-	 token = parser::token::STOP;
-      } else if (*tokenstr == "alpha") {
-	 token = parser::token::ALPHA;
-      } else if (*tokenstr == "mu") {
-	 token = parser::token::MU;
-      } else if (*tokenstr == "string") {
-	 token = parser::token::STRING;
-      } else if (*tokenstr == "integer") {
-	 token = parser::token::INTEGER;
-      } else if (*tokenstr == "div") {
-	 token = parser::token::DIV;
-      } else if (*tokenstr == "mod") {
-	 token = parser::token::MOD;
+      std::string_view text(source.data() + start, chpos - start);
+      int keyword = keyword_table.lookup(text);
+      if (keyword) {
+	 token = keyword;
       } else {
-	 yylval = std::make_shared<Identifier>(*tokenstr);
+	 yylval = std::make_shared<Identifier>(std::string(text));
       }
-      tokenstr = nullptr;
    } else if (ch == '"') {
-      tokenstr = std::make_unique<std::string>();
+      /* the token includes the opening quote */
+      auto start = chpos;
       nextch();
-      while (ch != '"') {
+      while (!eof && ch != '"') {
 	 nextch();
       }
-      yylval = std::make_shared<Identifier>(*tokenstr);
-      tokenstr = nullptr;
+      if (eof) {
+	 error("unexpected eof in string");
+      }
+      yylval = std::make_shared<Identifier>(
+	 std::string(source.data() + start, chpos - start));
       nextch();
    } else {
       switch (ch) {
@@ -270,27 +325,20 @@ void Scanner::nextch() {
    if (eof) {
       ch = 0; return;
    }
-   if (tokenstr) {
-      *tokenstr += ch;
-   }
-
-   if (line_index > line.length()) {
-      if (!std::getline(in, line)) {
-	 eof = true; ch = 0; return;
-      }
-      line_index = 0;
-   }
-   if (line_index == line.length()) {
-      ch = '\n';
+   chpos = index;
+   if (index < source.size()) {
+      ch = source[index++];
+   } else if (index == source.size() && index > 0 &&
+	 source[index-1] != '\n') {
+      /* an unterminated last line is terminated
+	 by a newline like std::getline does */
+      ch = '\n'; ++index;
    } else {
-      ch = line[line_index];
+      eof = true; ch = 0; chpos = source.size(); return;
    }
-   ++line_index;
 
    if (ch == '\n') {
       pos.lines();
-      lines.emplace_back(std::move(line));
-      line.clear();
    } else if (ch == '\t') {
       unsigned blanks = 8 - (pos.column - 1) % 8;
       pos.columns(blanks);
@@ -299,6 +347,15 @@ void Scanner::nextch() {
    }
 }
 
+std::string_view Scanner::get_line(std::size_t ln) const {
+   if (ln < 1 || ln > line_starts.size()) return {};
+   auto begin = line_starts[ln-1];
+   if (begin >= source.size()) return {};
+   auto end = source.find('\n', begin);
+   if (end == std::string::npos) end = source.size();
+   return std::string_view(source.data() + begin, end - begin);
+}
+
 void Scanner::error(char const* msg) {
    yyerror(tokenloc, context, msg);
 }
@@ -26,8 +26,11 @@
 #ifndef CSP_SCANNER_HPP
 #define CSP_SCANNER_HPP
 
+#include <cstddef>
 #include <iostream>
-#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "context.hpp"
 #include "parser.hpp"
@@ -45,26 +48,24 @@ namespace CSP {
 	 int get_token(semantic_type& yylval, location& yylloc);
 	 bool at_eof() const;
 
-	 const std::string& get_line(std::size_t ln) const {
-	    if (ln >= 1 && ln <= lines.size()) {
-	       return lines[ln-1];
-	    } else {
-	       return line;
-	    }
+	 std::string_view get_line(std::size_t ln) const;
+	 /* size of the input in bytes */
+	 std::size_t get_size() const {
+	    return source.size();
 	 }
 
       private:
 	 Context& context;
-	 std::istream& in;
 	 std::string input_name;
+	 /* the input is read at once */
+	 std::string source;
+	 std::vector<std::size_t> line_starts;
+	 std::size_t index = 0; // of the next character to be read
+	 std::size_t chpos = 0; // index of ch within source
 	 unsigned char ch = 0;
 	 bool eof = false;
 	 position oldpos, pos;
 	 location tokenloc;
-	 std::unique_ptr<std::string> tokenstr;
-	 std::vector<std::string> lines; // input lines
-	 std::string line; // current line
-	 std::size_t line_index = 1;
 
 	 // private mutators
 	 void nextch();
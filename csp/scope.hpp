@@ -29,7 +29,9 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "memory-accounting.hpp"
 #include "object.hpp"
 
 namespace CSP {
@@ -37,11 +39,13 @@ namespace CSP {
    class Scope;
    using ScopePtr = std::shared_ptr<Scope>;
 
-   class Scope {
+   class Scope: public Accounted<MemoryAccounting::scopes> {
       public:
 	 // constructors
 	 Scope() = default;
 	 Scope(ScopePtr outer) : outer(outer) {}
+	 Scope(const Scope&) = delete;
+	 Scope& operator=(const Scope&) = delete;
 
 	 // accessors
 	 template <typename T>
@@ -59,6 +63,18 @@ namespace CSP {
 	 ScopePtr get_outer() const {
 	    return outer;
 	 }
+	 /* true if name is the only name defined in this scope */
+	 bool binds_only(const std::string& name) const {
+	    return objects.size() == 1 && objects.begin()->first == name;
+	 }
+	 /* names defined in this scope, excluding outer scopes */
+	 std::vector<std::string> get_names() const {
+	    std::vector<std::string> names;
+	    for (auto& [name, object]: objects) {
+	       names.push_back(name);
+	    }
+	    return names;
+	 }
 
 	 // mutators
 	 bool insert(const std::string& name, ObjectPtr object) {
@@ -67,9 +83,13 @@ namespace CSP {
 	 }
 
       private:
+	 /* the entries are accounted as part of their scope */
+	 using Map = std::map<std::string, ObjectPtr, std::less<std::string>,
+	    AccountingAllocator<std::pair<const std::string, ObjectPtr>,
+	       MemoryAccounting::scopes, false>>;
+	 using Iterator = Map::const_iterator;
 	 ScopePtr outer;
-	 std::map<std::string, ObjectPtr> objects;
-	 using Iterator = std::map<std::string, ObjectPtr>::const_iterator;
+	 Map objects;
 
 	 std::pair<bool, Iterator> find(const std::string& name) const {
 	    auto it = objects.find(name);
@@ -38,6 +38,7 @@
 #include <vector>
 
 #include "alphabet.hpp"
+#include "coverage.hpp"
 #include "prefixed-process.hpp"
 #include "process.hpp"
 #include "reading-process.hpp"
@@ -56,6 +57,17 @@ namespace CSP {
 	    assert(choice);
 	    choices.push_back(choice);
 	 }
+	 const std::vector<ProcessPtr>& get_choices() const {
+	    return choices;
+	 }
+	 /* see Coverage */
+	 void set_branch_point(std::size_t index, Coverage::Point point) {
+	    assert(index < choices.size());
+	    if (branch_points.size() < choices.size()) {
+	       branch_points.resize(choices.size(), Coverage::none);
+	    }
+	    branch_points[index] = point;
+	 }
 	 void print(std::ostream& out) const override {
 	    bool first = true;
 	    out << "(";
@@ -65,11 +77,11 @@ namespace CSP {
 	       } else {
 		  out << " | ";
 	       }
-	       choice->print(out);
+	       print_subterm(out, choice);
 	    }
 	    out << ")";
 	 }
-	 Alphabet acceptable(StatusPtr status) const final {
+	 Alphabet internal_acceptable(StatusPtr status) const final {
 	    Alphabet set;
 	    for (auto choice: choices) {
 	       set = set + choice->acceptable(status);
@@ -79,12 +91,16 @@ namespace CSP {
 
       private:
 	 std::vector<ProcessPtr> choices;
+	 std::vector<Coverage::Point> branch_points; // if covered
 
 	 ActiveProcess internal_proceed(const std::string& event,
 	       StatusPtr status) final {
-	    for (auto choice: choices) {
-	       auto [p, s] = choice->proceed(event, status);
+	    for (std::size_t i = 0; i < choices.size(); ++i) {
+	       auto [p, s] = choices[i]->proceed(event, status);
 	       if (p) {
+		  if (i < branch_points.size()) {
+		     Coverage::hit(branch_points[i], event);
+		  }
 		  return {p, s};
 	       }
 	    }
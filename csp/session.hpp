@@ -0,0 +1,158 @@
+/* 
+   Copyright (c) 2011-2024 Andreas F. Borchert
+   All rights reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining
+   a copy of this software and associated documentation files (the
+   "Software"), to deal in the Software without restriction, including
+   without limitation the rights to use, copy, modify, merge, publish,
+   distribute, sublicense, and/or sell copies of the Software, and to
+   permit persons to whom the Software is furnished to do so, subject to
+   the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+   KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+   BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+*/
+
+#ifndef CSP_SESSION_HPP
+#define CSP_SESSION_HPP
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+#include "alphabet.hpp"
+#include "model.hpp"
+#include "process.hpp"
+#include "status.hpp"
+#include "uniformint.hpp"
+
+/*
+   A session runs a process of a model, i.e. it keeps track of
+   the current process and its status. A session must not be used
+   by multiple threads at the same time but any number of sessions
+   may run in parallel on the same model.
+
+   Snapshots and clones of a session are taken in O(1) as the
+   status is shared until one of the sharing parties is about to
+   change it (copy on write). Process terms are immutable and need
+   not to be copied.
+*/
+
+namespace CSP {
+
+   class Session {
+      public:
+	 enum Result {
+	    accepted, // event accepted
+	    terminated, // event accepted, and success is accepted next
+	    refused, // event not accepted, the process remains unchanged
+	    not_in_alphabet, // event not in the alphabet of the process
+	 };
+
+	 Session(ModelPtr model) :
+	       Session(model, UniformIntDistribution::random_seed()) {
+	 }
+	 /* runs with the same seed take the same
+	    non-deterministic decisions */
+	 Session(ModelPtr model, std::uint64_t seed) :
+	       model(model), process(model->get_process()),
+	       status(make_accounted<Status>(seed)) {
+	 }
+
+	 /* the state of a session which can be restored later */
+	 struct Snapshot {
+	    ProcessPtr process;
+	    StatusPtr status;
+	 };
+
+	 Result step(std::string_view event) {
+	    if (!process->get_alphabet().is_member(event)) {
+	       return not_in_alphabet;
+	    }
+	    /* proceed changes the status even if the event is
+	       refused at the end; hence the event is checked
+	       in advance where the decisions taken by acceptable
+	       are those proceed would take */
+	    own_status();
+	    name.assign(event);
+	    if (!process->acceptable(status).is_member(name)) {
+	       return refused;
+	    }
+	    auto [next_process, next_status] = process->proceed(name, status);
+	    assert(next_process);
+	    process = next_process; status = next_status;
+	    if (process->accepts_success(status)) return terminated;
+	    return accepted;
+	 }
+
+	 /* set of events that are acceptable next */
+	 Alphabet acceptable() const {
+	    own_status();
+	    return process->acceptable(status);
+	 }
+
+	 bool accepts_success() const {
+	    own_status();
+	    return process->accepts_success(status);
+	 }
+
+	 /* independent copy of this session which continues
+	    from the current state */
+	 Session clone() const {
+	    shared = true;
+	    return *this;
+	 }
+
+	 Snapshot snapshot() const {
+	    shared = true;
+	    return {process, status};
+	 }
+
+	 /* continue from a snapshot which remains valid */
+	 void restore(const Snapshot& snapshot) {
+	    process = snapshot.process; status = snapshot.status;
+	    shared = true;
+	 }
+
+	 ModelPtr get_model() const {
+	    return model;
+	 }
+
+	 ProcessPtr get_process() const {
+	    return process;
+	 }
+
+      private:
+	 ModelPtr model; // keeps the process terms alive
+	 ProcessPtr process;
+	 /* the status is changed by decisions which are taken
+	    by acceptable as well */
+	 mutable StatusPtr status;
+	 mutable bool shared = false; // status shared with others
+	 std::string name; // reused to avoid allocations per event
+
+	 /* copy the status if it is shared before it is changed */
+	 void own_status() const {
+	    if (shared) {
+	       status = Status::clone(status);
+	       shared = false;
+	    }
+	 }
+   };
+
+} // namespace CSP
+
+#endif
@@ -50,7 +50,7 @@ namespace CSP {
 	 void print(std::ostream& out) const override {
 	    out << "SKIP " << get_alphabet();
 	 }
-	 Alphabet acceptable(StatusPtr status) const final {
+	 Alphabet internal_acceptable(StatusPtr status) const final {
 	    return Alphabet("_success_");
 	 }
 
@@ -62,7 +62,7 @@ namespace CSP {
 	       StatusPtr status) final {
 	    /* should usually not be used */
 	    if (next_event == "_success_") {
-	       return {std::make_shared<StopProcess>(skip_alphabet), status};
+	       return {make_accounted<StopProcess>(skip_alphabet), status};
 	    } else {
 	       return {nullptr, status};
 	    }
@@ -28,10 +28,13 @@
 
 #include <cassert>
 #include <cstdlib>
+#include <map>
 #include <memory>
 #include <vector>
 #include <utility>
 
+#include "instrumentation.hpp"
+#include "memory-accounting.hpp"
 #include "scope.hpp"
 #include "uniformint.hpp"
 
@@ -46,20 +49,69 @@ namespace CSP {
    class Status;
    using StatusPtr = std::shared_ptr<Status>;
 
-   class Status {
+   class Status: public Accounted<MemoryAccounting::statuses> {
       public:
-	 Status() :
-	       scope(std::make_shared<Scope>()),
-	       prg(std::make_shared<UniformIntDistribution>()) {
+	 Status() : scope(make_accounted<Scope>()) {
+	    count();
 	 }
-	 Status(StatusPtr status) :
-	       scope(std::make_shared<Scope>(status->scope)),
-	       extended(status->extended),
-	       prg(status->prg) {
+	 Status(UniformIntDistribution prg) :
+	       scope(make_accounted<Scope>()), prg(prg) {
+	    count();
 	 }
+	 /* the scope is shared and must not be changed anymore */
+	 Status(UniformIntDistribution prg, ScopePtr scope) :
+	       scope(scope), prg(prg) {
+	    count();
+	 }
+	 /* each status has its own pseudo random generator
+	    which is split off from the generator of the
+	    status it is derived from; the scope is shared
+	    as new bindings are added through bind only;
+	    extensions are not inherited as they belong to
+	    the processes which worked on status */
+	 Status(StatusPtr status) : Status(status, status->scope) {
+	 }
+	 /* like Status(status) but with the given scope */
+	 Status(StatusPtr status, ScopePtr scope) :
+	       scope(scope), prg(status->prg.split()) {
+	    count();
+	 }
+	 Status(const Status& other) :
+	       Accounted(other),
+	       scope(other.scope), extended(other.extended),
+	       owned(other.owned), prg(other.prg) {
+	    count();
+	 }
+	 Status& operator=(const Status&) = delete;
 
 	 virtual ~Status() {}
 
+	 /* returns a status with an empty scope whose pseudo random
+	    generator is split off from that of the given status */
+	 static StatusPtr fresh(StatusPtr status) {
+	    return make_accounted<Status>(status->prg.split());
+	 }
+	 /* like fresh but with a scope that has been set up before */
+	 static StatusPtr fresh(StatusPtr status, ScopePtr scope) {
+	    return make_accounted<Status>(status->prg.split(), scope);
+	 }
+	 /* returns a status derived from status where name is bound
+	    to object; an innermost scope of status that binds nothing
+	    but name is left out as it would be shadowed anyway;
+	    this keeps the scopes of loops like mu X. (c?x -> X)
+	    from growing with each iteration */
+	 static StatusPtr bind(StatusPtr status, const std::string& name,
+	       ObjectPtr object) {
+	    auto outer = status->scope;
+	    if (outer->binds_only(name)) {
+	       outer = outer->get_outer();
+	    }
+	    auto s = make_accounted<Status>(status,
+	       make_accounted<Scope>(outer));
+	    s->set(name, object);
+	    return s;
+	 }
+
 	 template <typename T>
 	 auto lookup(const std::string& name) const {
 	    auto object = scope->lookup<T>(name);
@@ -73,19 +125,69 @@ namespace CSP {
 	 }
 
 	 auto draw(unsigned int upper_limit) {
-	    return prg->draw(upper_limit);
+	    return prg.draw(upper_limit);
 	 }
 	 bool flip() {
-	    return prg->flip();
+	    return prg.flip();
+	 }
+
+	 /* maps status objects to their copies such that
+	    status objects that are shared are copied just once */
+	 class Cloner {
+	    public:
+	       StatusPtr operator()(const StatusPtr& status) {
+		  if (!status) return status;
+		  auto it = clones.find(status.get());
+		  if (it != clones.end()) return it->second;
+		  auto copy = status->copy();
+		  clones[status.get()] = copy;
+		  copy->clone_members(*this);
+		  return copy;
+	       }
+	    private:
+	       std::map<const Status*, StatusPtr> clones;
+	 };
+
+	 /* returns a deep copy of status which evolves independently
+	    from status; scopes are shared as they are not
+	    changed once they have been set up */
+	 static StatusPtr clone(StatusPtr status) {
+	    Cloner cloner;
+	    return cloner(status);
+	 }
+
+      protected:
+	 /* to be overridden by all extensions of Status */
+	 virtual StatusPtr copy() const {
+	    return make_accounted<Status>(*this);
+	 }
+	 /* to be overridden by extensions which refer
+	    to other status objects */
+	 virtual void clone_members(Cloner& clone) {
+	    extended = clone(extended);
+	    for (auto& [owner, s]: owned) {
+	       s = clone(s);
+	    }
 	 }
 
       private:
+	 void count() {
+	    if (Instrumentation::enabled()) {
+	       Instrumentation::count_status();
+	    }
+	 }
+
 	 template<typename T, typename... Args>
 	 friend std::shared_ptr<T> get_status(StatusPtr status, Args&&... args);
+	 template<typename T, typename Owner>
+	 friend std::shared_ptr<T> get_owned_status(StatusPtr status,
+	    const Owner* owner);
 
 	 ScopePtr scope; // for bound variables and processes
 	 StatusPtr extended; // managed by get_status
-	 std::shared_ptr<UniformIntDistribution> prg;
+	 /* extensions per owner, managed by get_owned_status */
+	 std::vector<std::pair<const void*, StatusPtr>> owned;
+	 UniformIntDistribution prg;
    };
 
    /* access extended status and create it for status, if it
@@ -98,11 +200,27 @@ namespace CSP {
 	 std::shared_ptr<T> s = std::dynamic_pointer_cast<T>(status->extended);
 	 if (s) return s;
       }
-      auto extended = std::make_shared<T>(status, std::forward<Args>(args)...);
+      auto extended = make_accounted<T>(status, std::forward<Args>(args)...);
       status->extended = extended;
       return extended;
    }
 
+   /* like get_status but for extended status objects which
+      are bound to one particular process; hence processes
+      of the same type that work on the same status,
+      like those of a sequence, do not share their extensions */
+   template<typename T, typename Owner>
+   std::shared_ptr<T> get_owned_status(StatusPtr status, const Owner* owner) {
+      std::shared_ptr<T> s = std::dynamic_pointer_cast<T>(status);
+      if (s && s->owner == owner) return s;
+      for (auto& [o, extension]: status->owned) {
+	 if (o == owner) return std::static_pointer_cast<T>(extension);
+      }
+      auto extension = make_accounted<T>(status, owner);
+      status->owned.emplace_back(owner, extension);
+      return extension;
+   }
+
 } // namespace CSP
 
 #endif
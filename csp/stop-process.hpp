@@ -51,7 +51,7 @@ namespace CSP {
 	 void print(std::ostream& out) const override {
 	    out << "STOP " << get_alphabet();
 	 }
-	 Alphabet acceptable(StatusPtr status) const final {
+	 Alphabet internal_acceptable(StatusPtr status) const final {
 	    return Alphabet();
 	 }
 
@@ -34,6 +34,7 @@
 #include <cassert>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include "alphabet.hpp"
@@ -47,9 +48,9 @@ namespace CSP {
 	    assert(p); assert(q);
 	 }
 	 void print(std::ostream& out) const override {
-	    p->print(out); out << " // "; q->print(out);
+	    print_subterm(out, p); out << " // "; print_subterm(out, q);
 	 }
-	 Alphabet acceptable(StatusPtr status) const final {
+	 Alphabet internal_acceptable(StatusPtr status) const final {
 	    setup();
 	    return pq->acceptable(status);
 	 }
@@ -58,15 +59,16 @@ namespace CSP {
 	 ProcessPtr p;
 	 ProcessPtr q;
 	 mutable ProcessPtr pq; // (P || Q) \ alpha P
+	 mutable std::once_flag pq_initialized;
 
 	 void setup() const {
-	    if (!pq) {
-	       auto pp = std::make_shared<ParallelProcesses>(p, q);
+	    std::call_once(pq_initialized, [this]() {
+	       auto pp = make_accounted<ParallelProcesses>(p, q);
 	       auto p_alpha = p->get_alphabet();
 	       auto q_alpha = q->get_alphabet();
 	       auto conceal = p_alpha * q_alpha;
-	       pq = std::make_shared<ConcealedProcess>(pp, conceal);
-	    }
+	       pq = make_accounted<ConcealedProcess>(pp, conceal);
+	    });
 	 }
 
 	 ActiveProcess internal_proceed(const std::string& event,
@@ -31,6 +31,7 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 
 #include "alphabet.hpp"
 #include "identifier.hpp"
@@ -165,6 +166,34 @@ namespace CSP {
 	 }
    };
 
+   /* composition of two symbol changers, i.e. f(g(P)) */
+   class Composition: public SymbolChanger {
+      public:
+	 Composition(SymbolChangerPtr f, SymbolChangerPtr g) : f(f), g(g) {
+	    assert(f); assert(g);
+	 }
+
+	 void print(std::ostream& out) const final {
+	    f->print(out); out << " o "; g->print(out);
+	 }
+
+      private:
+	 SymbolChangerPtr f;
+	 SymbolChangerPtr g;
+
+	 std::string get_name(std::string name) final {
+	    return f->get_name(g->get_name(name));
+	 }
+
+	 std::string internal_map(std::string event) final {
+	    return f->map(g->map(event));
+	 }
+
+	 std::string internal_reverse_map(std::string event) final {
+	    return g->reverse_map(f->reverse_map(event));
+	 }
+   };
+
    /* see CSP 2.6.2 */
    class Qualifier: public SymbolChanger {
       public:
@@ -232,6 +261,52 @@ namespace CSP {
 	 }
    };
 
+   /* precomputed mappings of a symbol changer for all events
+      of a given alphabet; other events are passed to the
+      symbol changer */
+   class SymbolChangeTable {
+      public:
+	 SymbolChangeTable(SymbolChangerPtr f, const Alphabet& domain) : f(f) {
+	    assert(f);
+	    for (auto& event: domain) {
+	       auto changed = f->map(event);
+	       mapping[event] = changed;
+	       reversed_mapping[changed] = event;
+	    }
+	 }
+
+	 std::string map(const std::string& event) const {
+	    auto it = mapping.find(event);
+	    if (it != mapping.end()) {
+	       return it->second;
+	    } else {
+	       return f->map(event);
+	    }
+	 }
+	 Alphabet map(const Alphabet& a) const {
+	    Alphabet changed_a;
+	    for (auto& symbol: a) {
+	       changed_a.add(map(symbol));
+	    }
+	    return changed_a;
+	 }
+
+	 std::string reverse_map(const std::string& event) const {
+	    auto it = reversed_mapping.find(event);
+	    if (it != reversed_mapping.end()) {
+	       return it->second;
+	    } else {
+	       return f->reverse_map(event);
+	    }
+	 }
+
+      private:
+	 SymbolChangerPtr f;
+	 std::unordered_map<std::string, std::string> mapping;
+	 std::unordered_map<std::string, std::string> reversed_mapping;
+   };
+   using SymbolChangeTablePtr = std::shared_ptr<const SymbolChangeTable>;
+
 } // namespace CSP
 
 #endif
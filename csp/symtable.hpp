@@ -27,6 +27,7 @@
 #define CSP_SYMTABLE_HPP
 
 #include <cassert>
+#include <cstddef>
 #include <cstdlib>
 #include <deque>
 #include <functional>
@@ -60,8 +61,12 @@ namespace CSP {
 	    const location loc;
 	    const std::string name;
 	    std::function<bool()> resolve;
+	    bool resolved = false;
 	 };
+	 /* unresolved references in the order of their appearance,
+	    and indexed by their names */
 	 std::deque<Reference> unresolved;
+	 std::multimap<std::string, std::size_t> unresolved_names;
 
       public:
 	 // constructors
@@ -85,31 +90,44 @@ namespace CSP {
 
 	 // mutators
 	 void open() {
-	    auto inner = std::make_shared<Scope>(scope);
+	    auto inner = make_accounted<Scope>(scope);
 	    if (!scope) global = inner;
 	    scope = inner;
 	 }
 	 void close() {
 	    assert(scope);
-	    /* resolve all references if we are closing
-	       the out-most scope, this is required in cases
-	       of mutual recursion */
-	    std::deque<Reference> survivors;
-	    for (auto ref: unresolved) {
-	       if (!ref.resolve()) {
-		  survivors.push_back(ref);
-	       }
-	    }
-	    std::swap(unresolved, survivors);
 	    ScopePtr outer = scope->get_outer();
-	    if (!outer) {
-	       /* give error messages for all unresolved names */
+	    if (outer) {
+	       /* references to names of this scope must be resolved
+		  now; all others can be resolved as well by
+		  an enclosing scope which spares us to check
+		  all unresolved references at each scope */
+	       for (auto& name: scope->get_names()) {
+		  auto [begin, end] = unresolved_names.equal_range(name);
+		  for (auto it = begin; it != end;) {
+		     auto& ref = unresolved[it->second];
+		     if (ref.resolve()) {
+			ref.resolved = true;
+			it = unresolved_names.erase(it);
+		     } else {
+			++it;
+		     }
+		  }
+	       }
+	    } else {
+	       /* resolve all references if we are closing
+		  the out-most scope, this is required in cases
+		  of mutual recursion;
+		  give error messages for all unresolved names */
 	       unsigned errors = 0;
-	       for (auto ref: unresolved) {
-		  yyerror(ref.loc, context, "unable to resolve "
-		     "reference to process '%s'", ref.name);
-		  ++errors;
+	       for (auto& ref: unresolved) {
+		  if (!ref.resolved && !ref.resolve()) {
+		     yyerror(ref.loc, context, "unable to resolve "
+			"reference to process '%s'", ref.name);
+		     ++errors;
+		  }
 	       }
+	       unresolved.clear(); unresolved_names.clear();
 	       if (errors) {
 		  std::exit(1);
 	       }
@@ -131,6 +149,7 @@ namespace CSP {
 	 }
 	 void add_unresolved(const location& loc,
 	       std::string name, std::function<bool()> resolve) {
+	    unresolved_names.emplace(name, unresolved.size());
 	    unresolved.emplace_back(loc, std::move(name), std::move(resolve));
 	 }
 
@@ -23,44 +23,93 @@
    SOFTWARE.
 */
 
+#include <chrono>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <sstream>
+#include <string_view>
 
 #include "context.hpp"
 #include "parser.hpp"
 #include "scanner.hpp"
 
+/* prints the tokens of the given CSP source or, with -b, measures
+   the throughput of the scanner; -g n takes a generated source
+   of n mutually recursive process definitions */
+
 using namespace CSP;
 
+void usage(const char* cmdname) {
+   std::cerr << "Usage: " << cmdname << " [-b] [-g n] [filename]" <<
+      std::endl;
+   std::cerr << "Options:" << std::endl;
+   std::cerr << " -b         report throughput instead of tokens" <<
+      std::endl;
+   std::cerr << " -g n       scan a generated source with n definitions" <<
+      std::endl;
+   std::exit(1);
+}
+
+std::string generate(unsigned long n) {
+   std::ostringstream out;
+   out << "P0" << std::endl;
+   for (unsigned long i = 0; i < n; ++i) {
+      out << "P" << i << " = (a" << i << " -> P" << (i + 1) % n <<
+	 " | b" << i << " -> c" << i << " -> P" << (i * 7 + 3) % n <<
+	 ") -- process " << i << std::endl;
+   }
+   return out.str();
+}
+
 int main(int argc, char** argv) {
    char* cmdname = *argv++; --argc;
-   if (argc > 1) {
-      std::cerr << "Usage: " << cmdname << " [filename]" << std::endl;
-      std::exit(1);
+   bool opt_b = false; // benchmark
+   unsigned long generated = 0; // -g n
+   while (argc > 0 && **argv == '-' && argv[0][1]) {
+      std::string_view opt(*argv++); --argc;
+      if (opt == "-b") {
+	 opt_b = true;
+      } else if (opt == "-g") {
+	 if (argc == 0) usage(cmdname);
+	 char* endptr;
+	 generated = std::strtoul(*argv, &endptr, 10);
+	 if (endptr == *argv || *endptr || generated == 0) usage(cmdname);
+	 ++argv; --argc;
+      } else {
+	 usage(cmdname);
+      }
    }
+   if (argc > 1 || (argc > 0 && generated > 0)) usage(cmdname);
 
+   auto start = std::chrono::steady_clock::now();
    std::unique_ptr<Scanner> scanner;
-   std::unique_ptr<std::ifstream> fin = nullptr;
+   std::unique_ptr<std::istream> fin = nullptr;
+   std::string filename = "stdin";
    Context context;
-   if (argc > 0) {
-      char* fname = *argv++; --argc;
-      fin = std::make_unique<std::ifstream>(fname);
-      std::string filename(fname);
+   if (generated > 0) {
+      fin = std::make_unique<std::istringstream>(generate(generated));
+      filename = "generated";
+      start = std::chrono::steady_clock::now();
+   } else if (argc > 0) {
+      filename = *argv++; --argc;
+      fin = std::make_unique<std::ifstream>(filename);
       if (!*fin) {
-	 std::cerr << cmdname << ": unable to open " << fname <<
+	 std::cerr << cmdname << ": unable to open " << filename <<
 	    " for reading" << std::endl;
 	 std::exit(1);
       }
-      scanner = std::make_unique<Scanner>(context, *fin, filename);
-   } else {
-      scanner = std::make_unique<Scanner>(context, std::cin, "stdin");
    }
+   scanner = std::make_unique<Scanner>(context, fin? *fin: std::cin,
+      filename);
    semantic_type yylval;
    int token;
    location loc;
+   unsigned long tokens = 0;
    while ((token = scanner->get_token(yylval, loc)) != 0) {
+      ++tokens;
+      if (opt_b) continue;
       std::cout << token;
       if (yylval) {
 	 std::cout << " \"" << yylval << '"';
@@ -68,4 +117,12 @@ int main(int argc, char** argv) {
       }
       std::cout << std::endl;
    }
+   if (opt_b) {
+      std::chrono::duration<double> elapsed =
+	 std::chrono::steady_clock::now() - start;
+      auto bytes = scanner->get_size();
+      std::cout << tokens << " tokens, " << bytes << " bytes in " <<
+	 elapsed.count() << " s, " <<
+	 bytes / elapsed.count() / 1e6 << " MB/s" << std::endl;
+   }
 }
@@ -0,0 +1,160 @@
+/* 
+   Copyright (c) 2011-2024 Andreas F. Borchert
+   All rights reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining
+   a copy of this software and associated documentation files (the
+   "Software"), to deal in the Software without restriction, including
+   without limitation the rights to use, copy, modify, merge, publish,
+   distribute, sublicense, and/or sell copies of the Software, and to
+   permit persons to whom the Software is furnished to do so, subject to
+   the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+   KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+   BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+*/
+
+/*
+   runs sequences of steps through the Session API and
+   checks the results; exits with 1 if one of them fails
+*/
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "memory-accounting.hpp"
+#include "model.hpp"
+#include "session.hpp"
+
+using namespace CSP;
+
+unsigned int failures = 0;
+
+void expect(const std::string& what, const std::string& got,
+      const std::string& expected) {
+   if (got != expected) {
+      std::cerr << what << ": got " << got << ", expected " <<
+	 expected << std::endl;
+      ++failures;
+   }
+}
+
+std::string to_string(Session::Result result) {
+   switch (result) {
+      case Session::accepted: return "accepted";
+      case Session::terminated: return "terminated";
+      case Session::refused: return "refused";
+      case Session::not_in_alphabet: return "not-in-alphabet";
+   }
+   return "?";
+}
+
+std::string to_string(const Alphabet& alphabet) {
+   std::ostringstream os; os << alphabet;
+   return os.str();
+}
+
+/* a refused event must leave the session unchanged,
+   even if a pipe running in parallel accepted it */
+void refused_step_in_pipe() {
+   auto model = Model::load_string(
+      "MAIN = (P >> P) || R\n"
+      "P = (left?x -> right!x -> P)\n"
+      "R = (left!1 -> left!5 -> right!1 -> STOP alpha R)\n"
+      "alpha left = alpha right = integer\n", "refused-step-in-pipe");
+   if (!model) {
+      ++failures; return;
+   }
+   Session session(model, 1);
+   expect("step left.1", to_string(session.step("left.1")), "accepted");
+   expect("step left.7", to_string(session.step("left.7")), "refused");
+   expect("acceptable", to_string(session.acceptable()), "{left.5}");
+   expect("step left.5", to_string(session.step("left.5")), "accepted");
+}
+
+/* a refused step must be refused without proceeding
+   where operators would not cope with the refusal */
+void refused_step_in_concealment() {
+   auto model = Model::load_string(
+      "VM \\ {clink, clunk}\n"
+      "VM {coin, choc, clink, clunk, coffee} =\n"
+      "   (coin -> clink -> choc -> clunk -> VM)\n",
+      "refused-step-in-concealment");
+   if (!model) {
+      ++failures; return;
+   }
+   Session session(model, 1);
+   expect("step coin", to_string(session.step("coin")), "accepted");
+   expect("step coffee", to_string(session.step("coffee")), "refused");
+   expect("step choc", to_string(session.step("choc")), "accepted");
+}
+
+/* an event that was found acceptable must be accepted, even if
+   another reference of the same type works on the same status */
+void decisions_behind_references() {
+   auto model = Model::load_string(
+      "P = Q(1); R(2)\n"
+      "Q(x) = SKIP {a,b}\n"
+      "R(y) = (a -> SKIP {a,b}) |~| (b -> SKIP {a,b})\n",
+      "decisions-behind-references");
+   if (!model) {
+      ++failures; return;
+   }
+   for (std::uint64_t seed = 1; seed <= 20; ++seed) {
+      Session session(model, seed);
+      auto acceptable = session.acceptable();
+      if (acceptable.cardinality() != 1) {
+	 expect("acceptable", to_string(acceptable), "one event");
+	 continue;
+      }
+      auto event = *acceptable.begin();
+      expect("step " + event, to_string(session.step(event)),
+	 "terminated");
+   }
+}
+
+/* status objects of choices must neither form cycles
+   nor nest scopes with each step */
+void constant_memory_in_choices() {
+   MemoryAccounting::enable();
+   {
+      auto model = Model::load_string(
+	 "P = (SKIP{c,d} [] SKIP{c,d}); ((c -> P) [] (d -> P))\n",
+	 "constant-memory-in-choices");
+      if (!model) {
+	 ++failures; return;
+      }
+      Session session(model, 1);
+      for (int i = 0; i < 1000; ++i) {
+	 auto acceptable = session.acceptable();
+	 session.step(*acceptable.begin());
+      }
+   }
+   auto scopes = MemoryAccounting::get_usage(MemoryAccounting::scopes);
+   expect("live scopes", std::to_string(scopes.live_objects), "0");
+   if (scopes.peak_objects > 100) {
+      expect("peak scopes", std::to_string(scopes.peak_objects),
+	 "at most 100");
+   }
+}
+
+int main() {
+   refused_step_in_pipe();
+   refused_step_in_concealment();
+   decisions_behind_references();
+   constant_memory_in_choices();
+   if (failures > 0) std::exit(1);
+   std::cout << "OK" << std::endl;
+}
@@ -0,0 +1,183 @@
+/* 
+   Copyright (c) 2011-2024 Andreas F. Borchert
+   All rights reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining
+   a copy of this software and associated documentation files (the
+   "Software"), to deal in the Software without restriction, including
+   without limitation the rights to use, copy, modify, merge, publish,
+   distribute, sublicense, and/or sell copies of the Software, and to
+   permit persons to whom the Software is furnished to do so, subject to
+   the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+   KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+   BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+*/
+
+#ifndef CSP_TRACE_FORMAT_HPP
+#define CSP_TRACE_FORMAT_HPP
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "event-reader.hpp"
+
+/*
+   binary trace format:
+    - magic "CSPT", a version byte (1), and a flags byte
+      where bit 0 tells whether the traces are framed
+    - the number of events in the dictionary followed by
+      the events, each given by its length and its bytes
+    - the traces where each event is given by its index
+      in the dictionary plus 1; if framed, 0 terminates a trace
+   all numbers are encoded as unsigned LEB128 varints
+*/
+
+namespace CSP {
+
+   constexpr std::string_view binary_trace_magic("CSPT\x01", 5);
+   constexpr unsigned char binary_trace_framed = 1;
+
+   /* collects events and traces before they are written
+      as the dictionary needs to be known in advance */
+   class BinaryTraceWriter {
+      public:
+	 BinaryTraceWriter(bool framed) : framed(framed) {
+	 }
+
+	 void add_event(std::string_view event) {
+	    auto it = index.find(event);
+	    if (it == index.end()) {
+	       dictionary.emplace_back(event);
+	       it = index.emplace(dictionary.back(),
+		  dictionary.size()).first;
+	    }
+	    codes.push_back(it->second);
+	 }
+
+	 void end_trace() {
+	    if (framed) codes.push_back(0);
+	 }
+
+	 void write(std::ostream& out) const {
+	    std::string buf(binary_trace_magic);
+	    buf += char(framed? binary_trace_framed: 0);
+	    put_varint(buf, dictionary.size());
+	    for (auto& event: dictionary) {
+	       put_varint(buf, event.size());
+	       buf += event;
+	    }
+	    for (auto code: codes) {
+	       put_varint(buf, code);
+	       if (buf.size() >= 1 << 16) {
+		  out.write(buf.data(), buf.size()); buf.clear();
+	       }
+	    }
+	    out.write(buf.data(), buf.size());
+	 }
+
+      private:
+	 bool framed;
+	 std::vector<std::string> dictionary;
+	 std::map<std::string, std::uint32_t, std::less<>> index;
+	 std::vector<std::uint32_t> codes;
+
+	 static void put_varint(std::string& buf, std::uint64_t value) {
+	    while (value >= 0x80) {
+	       buf += char((value & 0x7f) | 0x80);
+	       value >>= 7;
+	    }
+	    buf += char(value);
+	 }
+   };
+
+   /* delivers the events of a binary trace */
+   class BinaryTraceReader {
+      public:
+	 enum Item {event, end_of_trace, end, error};
+
+	 BinaryTraceReader(EventReader& in) : in(in) {
+	 }
+
+	 /* returns true if the input looks like a binary trace */
+	 static bool is_binary(EventReader& in) {
+	    return in.starts_with(binary_trace_magic);
+	 }
+
+	 /* read the header; false is returned if it is not valid */
+	 bool read_header() {
+	    std::string_view magic;
+	    if (!in.next_bytes(binary_trace_magic.size(), magic) ||
+		  magic != binary_trace_magic) {
+	       return false;
+	    }
+	    unsigned char flags;
+	    if (!in.next_byte(flags)) return false;
+	    framed = flags & binary_trace_framed;
+	    std::uint64_t count;
+	    if (!get_varint(count)) return false;
+	    for (std::uint64_t i = 0; i < count; ++i) {
+	       std::uint64_t len; std::string_view event;
+	       if (!get_varint(len) || !in.next_bytes(len, event)) {
+		  return false;
+	       }
+	       dictionary.emplace_back(event);
+	    }
+	    return true;
+	 }
+
+	 bool is_framed() const {
+	    return framed;
+	 }
+
+	 /* fetch the next item; in case of event, the
+	    event is returned in ev */
+	 Item next(std::string_view& ev) {
+	    std::uint64_t code;
+	    unsigned char byte;
+	    if (!in.next_byte(byte)) return end;
+	    code = byte & 0x7f;
+	    for (unsigned int shift = 7; byte & 0x80; shift += 7) {
+	       if (shift >= 64 || !in.next_byte(byte)) return error;
+	       code |= std::uint64_t(byte & 0x7f) << shift;
+	    }
+	    if (code == 0) return end_of_trace;
+	    if (code > dictionary.size()) return error;
+	    ev = dictionary[code - 1];
+	    return event;
+	 }
+
+      private:
+	 EventReader& in;
+	 bool framed = false;
+	 std::vector<std::string> dictionary;
+
+	 bool get_varint(std::uint64_t& value) {
+	    unsigned char byte;
+	    value = 0;
+	    for (unsigned int shift = 0; shift < 64; shift += 7) {
+	       if (!in.next_byte(byte)) return false;
+	       value |= std::uint64_t(byte & 0x7f) << shift;
+	       if (!(byte & 0x80)) return true;
+	    }
+	    return false;
+	 }
+   };
+
+} // namespace CSP
+
+#endif
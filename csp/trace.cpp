@@ -23,40 +23,702 @@
    SOFTWARE.
 */
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <fcntl.h>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
 #include <tuple>
 #include <unistd.h>
+#include <utility>
+#include <vector>
 
 #include "context.hpp"
+#include "coverage.hpp"
+#include "event-reader.hpp"
+#include "instrumentation.hpp"
+#include "memory-accounting.hpp"
 #include "parser.hpp"
 #include "process.hpp"
 #include "scanner.hpp"
 #include "status.hpp"
 #include "symtable.hpp"
+#include "trace-format.hpp"
+#include "uniformint.hpp"
 
 using namespace CSP;
 
 void usage(const char* cmdname) {
-   std::cerr << "Usage: " << cmdname << " [-Aaepv] [-P n] source.csp" <<
+   std::cerr << "Usage: " << cmdname <<
+      " [-Aaepuv] [-P n [-R runs]] [-S seed] [-j threads]" <<
+      " [--batch traces] [--output=mode]" << std::endl;
+   std::cerr << "   [--print-depth=n] [--print-diff] [--stats[=json]]" <<
+      " [--mem-report]" << std::endl;
+   std::cerr << "   [--coverage] [--coverage-source=file] source.csp" <<
       std::endl;
    std::cerr << "Options:" << std::endl;
-   std::cerr << " -A   print alphabet, one symbol per line, and exit" <<
+   std::cerr << " -A         print alphabet, one symbol per line, and exit" <<
       std::endl;
-   std::cerr << " -a   do not print the alphabet at the beginning" << std::endl;
-   std::cerr << " -e   print events, if accepted" << std::endl;
-   std::cerr << " -p   do not print current process after each event" <<
+   std::cerr << " -a         do not print the alphabet at the beginning" <<
       std::endl;
-   std::cerr << " -P n chose event by random and stop after n events" <<
+   std::cerr << " -e         print events, if accepted" << std::endl;
+   std::cerr << " -j threads number of threads for -R and --batch" <<
       std::endl;
-   std::cerr << " -v   do not print the set of acceptable events" <<
+   std::cerr << " -p         do not print current process after each event" <<
       std::endl;
+   std::cerr << " -P n       chose event by random and stop after n events" <<
+      std::endl;
+   std::cerr << " -R runs    perform the given number of random runs " <<
+      "and print statistics" << std::endl;
+   std::cerr << " -S seed    seed for the pseudo random generator" <<
+      std::endl;
+   std::cerr << " -u         the input undo reverts the last event" <<
+      std::endl;
+   std::cerr << " -v         do not print the set of acceptable events" <<
+      std::endl;
+   std::cerr << " --batch traces" << std::endl;
+   std::cerr << "            check all traces of the given file, " <<
+      "one trace per line" << std::endl;
+   std::cerr << " --output=text|jsonl|events|quiet" << std::endl;
+   std::cerr << "            output format of a single run" << std::endl;
+   std::cerr << " --print-depth=n" << std::endl;
+   std::cerr << "            print process terms up to the given depth" <<
+      std::endl;
+   std::cerr << " --print-diff" << std::endl;
+   std::cerr << "            print subterms that did not change " <<
+      "as [=]" << std::endl;
+   std::cerr << " --stats[=table|json]" << std::endl;
+   std::cerr << "            print counters and times per operator " <<
+      "to stderr at exit" << std::endl;
+   std::cerr << " --mem-report" << std::endl;
+   std::cerr << "            print live and peak memory per subsystem " <<
+      "to stderr at exit" << std::endl;
+   std::cerr << " --coverage" << std::endl;
+   std::cerr << "            print coverage of the model " <<
+      "to stderr at exit" << std::endl;
+   std::cerr << " --coverage-source=file" << std::endl;
+   std::cerr << "            write a copy of the model annotated " <<
+      "with hit counts at exit" << std::endl;
    std::exit(1);
 }
 
+void print_memory_report() {
+   MemoryAccounting::print_report(std::cerr);
+}
+
+/* see option --stats */
+bool stats_json = false;
+void print_instrumentation() {
+   if (stats_json) {
+      Instrumentation::print_json(std::cerr);
+   } else {
+      Instrumentation::print_table(std::cerr);
+   }
+}
+
+/* see options --coverage and --coverage-source */
+std::string coverage_model; // file name of the model
+const char* coverage_source = nullptr;
+void print_coverage() {
+   Coverage::print_report(std::cerr, coverage_model);
+   if (coverage_source &&
+	 !Coverage::write_annotated_source(coverage_model, coverage_source)) {
+      std::cerr << "unable to write " << coverage_source << std::endl;
+   }
+}
+
+/* statistics of random runs, see option -R */
+struct Statistics {
+   unsigned long runs = 0;
+   unsigned long deadlocks = 0; // no acceptable events left
+   unsigned long terminations = 0; // success accepted
+   unsigned long failures = 0; // event not accepted
+   unsigned long events = 0; // total number of accepted events
+   std::map<std::string, unsigned long> frequency; // per event
+
+   void add(const Statistics& other) {
+      runs += other.runs;
+      deadlocks += other.deadlocks;
+      terminations += other.terminations;
+      failures += other.failures;
+      events += other.events;
+      for (auto& [event, count]: other.frequency) {
+	 frequency[event] += count;
+      }
+   }
+};
+
+/* run process with up to max_events randomly chosen events */
+void random_run(ProcessPtr process, std::uint64_t seed,
+      unsigned int max_events, Statistics& stats) {
+   auto status = make_accounted<Status>(seed);
+   ++stats.runs;
+   for (unsigned int count = 0; count < max_events; ++count) {
+      if (process->accepts_success(status)) {
+	 ++stats.terminations; return;
+      }
+      auto acceptable = process->acceptable(status);
+      if (acceptable.cardinality() == 0) {
+	 ++stats.deadlocks; return;
+      }
+      auto chose = status->draw(acceptable.cardinality());
+      auto event = *std::next(acceptable.begin(), chose);
+      std::tie(process, status) = process->proceed(event, status);
+      if (!process) {
+	 static std::mutex cerr_mutex;
+	 std::lock_guard<std::mutex> lock(cerr_mutex);
+	 std::cerr << "cannot accept " << event <<
+	    " (seed " << seed << ")" << std::endl;
+	 ++stats.failures; return;
+      }
+      ++stats.events; ++stats.frequency[event];
+   }
+   if (process->accepts_success(status)) {
+      ++stats.terminations;
+   }
+}
+
+/* invoke f(i, thread) for all i in [0, count) using the
+   given number of threads */
+template<typename F>
+void run_in_parallel(unsigned long count, unsigned int threads, F f) {
+   std::atomic<unsigned long> next{0};
+   std::vector<std::thread> workers;
+   for (unsigned int thread = 0; thread < threads; ++thread) {
+      workers.emplace_back([&, thread]() {
+	 unsigned long i;
+	 while ((i = next++) < count) {
+	    f(i, thread);
+	 }
+      });
+   }
+   for (auto& worker: workers) {
+      worker.join();
+   }
+}
+
+/* derive count seeds from seed such that results
+   do not depend on the number of threads */
+std::vector<std::uint64_t> derive_seeds(std::uint64_t seed,
+      unsigned long count) {
+   std::vector<std::uint64_t> seeds(count);
+   UniformIntDistribution prg(seed);
+   for (auto& s: seeds) {
+      s = prg.split().get_seed();
+   }
+   return seeds;
+}
+
+/* perform the given number of random runs using the given
+   number of threads which share process */
+Statistics random_runs(ProcessPtr process, std::uint64_t seed,
+      unsigned int max_events, unsigned long runs, unsigned int threads) {
+   /* make sure that the alphabets are constructed
+      before process is shared */
+   process->get_alphabet();
+   auto seeds = derive_seeds(seed, runs);
+   std::vector<Statistics> stats(threads);
+   run_in_parallel(runs, threads, [&](unsigned long run, unsigned int thread) {
+      random_run(process, seeds[run], max_events, stats[thread]);
+   });
+   Statistics total;
+   for (auto& s: stats) {
+      total.add(s);
+   }
+   return total;
+}
+
+void print_percentage(unsigned long count, unsigned long total) {
+   std::cout << count;
+   if (total > 0) {
+      std::cout << " (" << 100.0 * count / total << "%)";
+   }
+   std::cout << std::endl;
+}
+
+void print_statistics(const Statistics& stats) {
+   std::cout << "Runs: " << stats.runs << std::endl;
+   std::cout << "Deadlocks: "; print_percentage(stats.deadlocks, stats.runs);
+   std::cout << "Terminations: ";
+   print_percentage(stats.terminations, stats.runs);
+   std::cout << "Failures: "; print_percentage(stats.failures, stats.runs);
+   std::cout << "Average trace length: ";
+   if (stats.runs > 0) {
+      std::cout << double(stats.events) / stats.runs;
+   } else {
+      std::cout << 0;
+   }
+   std::cout << std::endl;
+   /* event histogram, most frequent events first */
+   std::vector<std::pair<std::string, unsigned long>> frequency(
+      stats.frequency.begin(), stats.frequency.end());
+   std::stable_sort(frequency.begin(), frequency.end(),
+      [](auto& a, auto& b) {
+	 return a.second > b.second;
+      });
+   std::cout << "Events:" << std::endl;
+   for (auto& [event, count]: frequency) {
+      std::cout << "   " << event << " ";
+      print_percentage(count, stats.events);
+   }
+}
+
+/* verdict of a trace, see option --batch */
+struct Verdict {
+   enum {accepted, refused, not_in_alphabet} kind = accepted;
+   std::size_t position = 0; // of the offending event, starting from 1
+   std::string event; // offending event
+};
+
+/* all traces to be checked are organized in a trie
+   such that common prefixes are checked just once */
+struct TraceTrie {
+   struct Node {
+      // event -> node
+      std::map<std::string, std::size_t, std::less<>> children;
+      std::vector<std::size_t> traces; // traces ending here
+      std::size_t depth = 0;
+   };
+   std::vector<Node> nodes{1}; // root at index 0
+
+   /* return the child of node that is reached by event */
+   std::size_t extend(std::size_t node, std::string_view event) {
+      auto it = nodes[node].children.find(event);
+      if (it != nodes[node].children.end()) return it->second;
+      auto child = nodes.size();
+      nodes[node].children.emplace(event, child);
+      nodes.emplace_back();
+      nodes[child].depth = nodes[node].depth + 1;
+      return child;
+   }
+
+   /* add the trace of whitespace-separated events */
+   void add(std::string_view trace, std::size_t index) {
+      std::size_t node = 0;
+      std::string_view event;
+      while (EventReader::next_token(trace, event)) {
+	 node = extend(node, event);
+      }
+      nodes[node].traces.push_back(index);
+   }
+
+   /* assign verdict to all traces of the subtree rooted at node */
+   void set_verdict(std::size_t node, const Verdict& verdict,
+	 std::vector<Verdict>& verdicts) const {
+      std::vector<std::size_t> stack{node};
+      while (!stack.empty()) {
+	 auto n = stack.back(); stack.pop_back();
+	 for (auto index: nodes[n].traces) {
+	    verdicts[index] = verdict;
+	 }
+	 for (auto& [event, child]: nodes[n].children) {
+	    stack.push_back(child);
+	 }
+      }
+   }
+
+   /* let process consume the event leading to child;
+      false is returned if it is not accepted */
+   bool step(std::size_t child, const std::string& event,
+	 ProcessPtr& process, StatusPtr& status,
+	 std::vector<Verdict>& verdicts) const {
+      if (!process->get_alphabet().is_member(event)) {
+	 set_verdict(child, {Verdict::not_in_alphabet,
+	    nodes[child].depth, event}, verdicts);
+	 return false;
+      }
+      std::tie(process, status) = process->proceed(event, status);
+      if (!process) {
+	 set_verdict(child, {Verdict::refused,
+	    nodes[child].depth, event}, verdicts);
+	 return false;
+      }
+      return true;
+   }
+
+   /* check the subtree rooted at node where process
+      with its status has consumed the prefix leading to node;
+      the process is stepped once per edge of the trie and
+      the status is cloned at branching points only */
+   void check(std::size_t node, ProcessPtr process, StatusPtr status,
+	 std::vector<Verdict>& verdicts) const {
+      struct State {
+	 std::size_t node;
+	 ProcessPtr process;
+	 StatusPtr status;
+      };
+      std::vector<State> stack{{node, process, status}};
+      while (!stack.empty()) {
+	 auto [n, p, s] = stack.back(); stack.pop_back();
+	 /* traces ending at n are accepted by default */
+	 if (p->accepts_success(s)) {
+	    /* like trace we accept everything that follows */
+	    set_verdict(n, Verdict(), verdicts);
+	    continue;
+	 }
+	 std::size_t remaining = nodes[n].children.size();
+	 for (auto& [event, child]: nodes[n].children) {
+	    /* the last child may continue with the original status */
+	    auto cp = p;
+	    auto cs = --remaining > 0? Status::clone(s): s;
+	    if (step(child, event, cp, cs, verdicts)) {
+	       stack.push_back({child, cp, cs});
+	    }
+	 }
+      }
+   }
+};
+
+/* add the traces of a binary trace file to trie
+   and return their number */
+std::size_t add_binary_traces(TraceTrie& trie, EventReader& in) {
+   BinaryTraceReader reader(in);
+   if (!reader.read_header()) {
+      std::cerr << "invalid binary trace" << std::endl;
+      std::exit(1);
+   }
+   std::size_t count = 0;
+   std::size_t node = 0;
+   bool pending = !reader.is_framed(); // unframed: one trace
+   std::string_view event;
+   for (;;) {
+      switch (reader.next(event)) {
+	 case BinaryTraceReader::event:
+	    node = trie.extend(node, event); pending = true;
+	    break;
+	 case BinaryTraceReader::end_of_trace:
+	    trie.nodes[node].traces.push_back(count++);
+	    node = 0; pending = false;
+	    break;
+	 case BinaryTraceReader::end:
+	    if (pending) {
+	       trie.nodes[node].traces.push_back(count++);
+	    }
+	    return count;
+	 case BinaryTraceReader::error:
+	    std::cerr << "corrupted binary trace" << std::endl;
+	    std::exit(1);
+      }
+   }
+}
+
+/* check all traces of the given file, one trace per line
+   or in the binary format, and print the verdicts;
+   true is returned if all traces were accepted */
+bool check_traces(ProcessPtr process, EventReader& in,
+      std::uint64_t seed, unsigned int threads) {
+   TraceTrie trie;
+   std::size_t count = 0;
+   if (BinaryTraceReader::is_binary(in)) {
+      count = add_binary_traces(trie, in);
+   } else {
+      std::string_view line;
+      while (in.next_line(line)) {
+	 trie.add(line, count++);
+      }
+   }
+   /* make sure that the alphabets are constructed
+      before process is shared */
+   process->get_alphabet();
+   std::vector<Verdict> verdicts(count);
+   auto status = make_accounted<Status>(seed);
+   if (process->accepts_success(status)) {
+      /* nothing to be done as all traces are accepted */
+   } else {
+      /* the subtrees below the root are distributed among the
+	 threads, each of them starting with a copy of the
+	 initial status */
+      std::vector<std::pair<std::string, std::size_t>> subtrees(
+	 trie.nodes[0].children.begin(), trie.nodes[0].children.end());
+      std::vector<StatusPtr> statuses;
+      for (std::size_t i = 0; i < subtrees.size(); ++i) {
+	 statuses.push_back(Status::clone(status));
+      }
+      run_in_parallel(subtrees.size(), threads,
+	 [&](unsigned long i, unsigned int thread) {
+	    auto& [event, child] = subtrees[i];
+	    auto p = process; auto s = statuses[i];
+	    if (!trie.step(child, event, p, s, verdicts)) return;
+	    trie.check(child, p, s, verdicts);
+	 });
+   }
+   bool ok = true;
+   for (std::size_t i = 0; i < verdicts.size(); ++i) {
+      auto& verdict = verdicts[i];
+      std::cout << i + 1 << ": ";
+      switch (verdict.kind) {
+	 case Verdict::accepted:
+	    std::cout << "accepted"; break;
+	 case Verdict::refused:
+	    std::cout << "refused at " << verdict.position <<
+	       ": " << verdict.event;
+	    ok = false; break;
+	 case Verdict::not_in_alphabet:
+	    std::cout << "not in alphabet at " << verdict.position <<
+	       ": " << verdict.event;
+	    ok = false; break;
+      }
+      std::cout << '\n';
+   }
+   std::cout.flush();
+   return ok;
+}
+
+/* output of a single run, see option --output */
+class TraceOutput {
+   public:
+      enum Mode {text, jsonl, quiet, events};
+
+      /* the flags correspond to the options -a, -e, -p, and -v;
+	 they are ignored in the quiet and events modes */
+      TraceOutput(std::ostream& out, Mode mode, bool print_alphabet,
+	    bool print_events, bool print_process, bool print_acceptable,
+	    bool interactive) :
+	    out(out), mode(mode), print_alphabet(print_alphabet),
+	    print_events(print_events), print_process(print_process),
+	    print_acceptable(print_acceptable), interactive(interactive) {
+      }
+
+      /* restrict the printing of process terms,
+	 see options --print-depth and --print-diff */
+      void restrict_printing(unsigned int max_depth, bool diff) {
+	 if (max_depth > 0 || diff) {
+	    control = std::make_unique<PrintControl>(max_depth, diff);
+	 }
+      }
+
+      void start(ProcessPtr process, StatusPtr status) {
+	 switch (mode) {
+	    case text:
+	       if (print_process) {
+		  out << "Tracing: "; print(out, process); out << '\n';
+	       }
+	       if (print_alphabet) {
+		  out << "Alphabet: " << process->get_alphabet() << '\n';
+	       }
+	       if (print_acceptable) {
+		  out << "Acceptable: " << process->acceptable(status) << '\n';
+	       }
+	       break;
+	    case jsonl:
+	       out << "{\"step\":0";
+	       if (print_process) {
+		  out << ",\"process\":"; print_json(process);
+	       }
+	       if (print_alphabet) {
+		  out << ",\"alphabet\":"; print_json(process->get_alphabet());
+	       }
+	       if (print_acceptable) {
+		  out << ",\"acceptable\":";
+		  print_json(process->acceptable(status));
+	       }
+	       out << "}\n";
+	       break;
+	    case quiet:
+	    case events:
+	       break;
+	 }
+      }
+
+      /* event has been accepted by the preceding process */
+      void accepted(std::string_view event,
+	    ProcessPtr process, StatusPtr status) {
+	 ++step;
+	 switch (mode) {
+	    case text:
+	       if (print_events) {
+		  out << event << '\n';
+	       }
+	       if (print_process) {
+		  out << "Process: "; print(out, process); out << '\n';
+	       }
+	       if (print_acceptable) {
+		  out << "Acceptable: " << process->acceptable(status) << '\n';
+	       }
+	       break;
+	    case jsonl:
+	       out << "{\"step\":" << step << ",\"event\":";
+	       print_json_string(event);
+	       if (print_process) {
+		  out << ",\"process\":"; print_json(process);
+	       }
+	       if (print_acceptable) {
+		  out << ",\"acceptable\":";
+		  print_json(process->acceptable(status));
+	       }
+	       out << "}\n";
+	       break;
+	    case events:
+	       out << event << '\n';
+	       break;
+	    case quiet:
+	       break;
+	 }
+      }
+
+      /* event has been undone, process is the restored process */
+      void undone(std::string_view event,
+	    ProcessPtr process, StatusPtr status) {
+	 --step;
+	 switch (mode) {
+	    case text:
+	       out << "Undone: " << event << '\n';
+	       if (print_process) {
+		  out << "Process: "; print(out, process); out << '\n';
+	       }
+	       if (print_acceptable) {
+		  out << "Acceptable: " << process->acceptable(status) << '\n';
+	       }
+	       break;
+	    case jsonl:
+	       out << "{\"step\":" << step << ",\"undone\":";
+	       print_json_string(event);
+	       if (print_process) {
+		  out << ",\"process\":"; print_json(process);
+	       }
+	       if (print_acceptable) {
+		  out << ",\"acceptable\":";
+		  print_json(process->acceptable(status));
+	       }
+	       out << "}\n";
+	       break;
+	    case quiet:
+	    case events:
+	       break;
+	 }
+      }
+
+      void nothing_to_undo() {
+	 switch (mode) {
+	    case text:
+	       out << "Nothing to undo\n";
+	       break;
+	    case jsonl:
+	       out << "{\"nothing_to_undo\":true}\n";
+	       break;
+	    case quiet:
+	    case events:
+	       break;
+	 }
+      }
+
+      void not_in_alphabet(std::string_view event) {
+	 switch (mode) {
+	    case text:
+	       out << "Not in alphabet: " << event << '\n';
+	       break;
+	    case jsonl:
+	       out << "{\"not_in_alphabet\":"; print_json_string(event); out << "}\n";
+	       break;
+	    case quiet:
+	    case events:
+	       break;
+	 }
+      }
+
+      /* the run ends as event is not accepted */
+      void refused(std::string_view event) {
+	 if (mode == jsonl) {
+	    out << "{\"result\":\"refused\",\"event\":";
+	    print_json_string(event); out << "}\n";
+	 }
+	 /* make sure that our output preceeds the error message */
+	 out.flush();
+      }
+
+      /* the run ends successfully */
+      void ok() {
+	 switch (mode) {
+	    case text:
+	       out << "OK\n";
+	       break;
+	    case jsonl:
+	       out << "{\"result\":\"ok\"}\n";
+	       break;
+	    case quiet:
+	    case events:
+	       break;
+	 }
+	 out.flush();
+      }
+
+      /* to be called before the next event is read */
+      void await_event() {
+	 if (interactive) out.flush();
+      }
+
+   private:
+      std::ostream& out;
+      Mode mode;
+      bool print_alphabet;
+      bool print_events;
+      bool print_process;
+      bool print_acceptable;
+      bool interactive; // flush output before input is read
+      unsigned long step = 0;
+      std::unique_ptr<PrintControl> control; // if printing is restricted
+
+      void print(std::ostream& out, ProcessPtr process) {
+	 if (control) {
+	    control->print(out, process);
+	 } else {
+	    out << process;
+	 }
+      }
+
+      void print_json_string(std::string_view s) {
+	 out << '"';
+	 for (char ch: s) {
+	    switch (ch) {
+	       case '"': out << "\\\""; break;
+	       case '\\': out << "\\\\"; break;
+	       case '\n': out << "\\n"; break;
+	       case '\t': out << "\\t"; break;
+	       default:
+		  if (static_cast<unsigned char>(ch) < ' ') {
+		     static const char hex[] = "0123456789abcdef";
+		     out << "\\u00" << hex[ch >> 4] << hex[ch & 0xf];
+		  } else {
+		     out << ch;
+		  }
+		  break;
+	    }
+	 }
+	 out << '"';
+      }
+
+      void print_json(const Alphabet& alphabet) {
+	 out << '[';
+	 bool first = true;
+	 for (auto& event: alphabet) {
+	    if (first) {
+	       first = false;
+	    } else {
+	       out << ',';
+	    }
+	    print_json_string(event);
+	 }
+	 out << ']';
+      }
+
+      void print_json(ProcessPtr process) {
+	 std::ostringstream os;
+	 print(os, process);
+	 print_json_string(os.str());
+      }
+};
+
 int main(int argc, char** argv) {
    const char* cmdname = *argv++; --argc;
    if (argc == 0) usage(cmdname);
@@ -68,8 +730,97 @@ int main(int argc, char** argv) {
    bool opt_p = true;  // print current process after each event
    bool opt_P = false; // chose event by random and stop after n events
    unsigned int event_count = 0; // parameter of -P
+   bool opt_R = false; // perform multiple random runs
+   unsigned long runs = 0; // parameter of -R
+   unsigned int threads = 1; // parameter of -j
+   bool opt_S = false; // seed given
+   std::uint64_t seed = 0; // parameter of -S
+   bool opt_u = false; // support undo
    bool opt_v = true;  // print current set of acceptable events
+   const char* batch = nullptr; // parameter of --batch
+   auto output_mode = TraceOutput::text; // parameter of --output
+   unsigned int print_depth = 0; // parameter of --print-depth
+   bool print_diff = false; // --print-diff given
+   /* fetch argument of a long option of the form
+      --name=value or --name value */
+   auto get_long_arg = [&](const char* value) -> const char* {
+      if (value) return value;
+      --argc; ++argv;
+      if (argc == 0) usage(cmdname);
+      return *argv;
+   };
+   /* fetch numerical argument of an option */
+   auto get_arg = [&](char*& cp) -> std::uint64_t {
+      char* arg = cp+1;
+      if (!*arg) {
+	 --argc; ++argv;
+	 if (argc == 0) usage(cmdname);
+	 arg = *argv;
+      }
+      char* endptr;
+      auto value = std::strtoull(arg, &endptr, 10);
+      if (endptr == arg || *endptr) usage(cmdname);
+      cp = endptr-1;
+      return value;
+   };
    while (argc > 0 && **argv == '-') {
+      if (argv[0][1] == '-') {
+	 std::string name(*argv + 2);
+	 const char* value = nullptr;
+	 auto pos = name.find('=');
+	 if (pos != std::string::npos) {
+	    value = *argv + 2 + pos + 1;
+	    name = name.substr(0, pos);
+	 }
+	 if (name == "batch") {
+	    batch = get_long_arg(value);
+	 } else if (name == "output") {
+	    std::string mode = get_long_arg(value);
+	    if (mode == "text") {
+	       output_mode = TraceOutput::text;
+	    } else if (mode == "jsonl") {
+	       output_mode = TraceOutput::jsonl;
+	    } else if (mode == "events") {
+	       output_mode = TraceOutput::events;
+	    } else if (mode == "quiet") {
+	       output_mode = TraceOutput::quiet;
+	    } else {
+	       usage(cmdname);
+	    }
+	 } else if (name == "print-depth") {
+	    const char* arg = get_long_arg(value);
+	    char* endptr;
+	    print_depth = std::strtoul(arg, &endptr, 10);
+	    if (endptr == arg || *endptr) usage(cmdname);
+	 } else if (name == "print-diff" && !value) {
+	    print_diff = true;
+	 } else if (name == "mem-report" && !value) {
+	    if (!MemoryAccounting::enabled()) {
+	       MemoryAccounting::enable();
+	       std::atexit(print_memory_report);
+	    }
+	 } else if (name == "coverage" && !value) {
+	    Coverage::enable();
+	 } else if (name == "coverage-source") {
+	    coverage_source = get_long_arg(value);
+	    Coverage::enable();
+	 } else if (name == "stats") {
+	    std::string mode = value? value: "table";
+	    if (mode == "json") {
+	       stats_json = true;
+	    } else if (mode != "table") {
+	       usage(cmdname);
+	    }
+	    if (!Instrumentation::enabled()) {
+	       Instrumentation::enable();
+	       std::atexit(print_instrumentation);
+	    }
+	 } else {
+	    usage(cmdname);
+	 }
+	 --argc; ++argv;
+	 continue;
+      }
       for (char* cp = *argv + 1; *cp; ++cp) {
 	 switch (*cp) {
 	    case 'A':
@@ -80,21 +831,18 @@ int main(int argc, char** argv) {
 	       opt_e = true; break;
 	    case 'p':
 	       opt_p = false; break;
-	    case 'P':
-	       {
-		  opt_P = true;
-		  char* arg = cp+1;
-		  if (!*arg) {
-		     --argc; ++argv;
-		     if (argc == 0) usage(cmdname);
-		     arg = *argv;
-		  }
-		  char* endptr;
-		  event_count = std::strtoul(arg, &endptr, 10);
-		  if (*endptr) usage(cmdname);
-		  cp = endptr-1;
-	       }
+	    case 'j':
+	       threads = get_arg(cp);
+	       if (threads == 0) usage(cmdname);
 	       break;
+	    case 'P':
+	       opt_P = true; event_count = get_arg(cp); break;
+	    case 'R':
+	       opt_R = true; runs = get_arg(cp); break;
+	    case 'S':
+	       opt_S = true; seed = get_arg(cp); break;
+	    case 'u':
+	       opt_u = true; break;
 	    case 'v':
 	       opt_v = false; break;
 	    default:
@@ -104,6 +852,8 @@ int main(int argc, char** argv) {
       --argc; ++argv;
    }
    if (argc != 1) usage(cmdname);
+   if (opt_R && !opt_P) usage(cmdname);
+   if (batch && opt_P) usage(cmdname);
 
    const char* fname = *argv++; --argc;
    std::ifstream fin(fname);
@@ -113,6 +863,10 @@ int main(int argc, char** argv) {
       std::exit(1);
    }
    std::string filename(fname);
+   if (Coverage::enabled()) {
+      coverage_model = filename;
+      std::atexit(print_coverage);
+   }
    Context context;
    Scanner scanner(context, fin, filename);
    SymTable symtab(context);
@@ -127,19 +881,51 @@ int main(int argc, char** argv) {
 	 }
 	 std::exit(0);
       }
-      auto status = std::make_shared<Status>();
-      if (opt_p) {
-	 std::cout << "Tracing: " << process << std::endl;
+      if (!opt_S) {
+	 seed = UniformIntDistribution::random_seed();
       }
-      if (opt_a) {
-	 std::cout << "Alphabet: " << process->get_alphabet() << std::endl;
+      if (batch) {
+	 int fd = open(batch, O_RDONLY);
+	 if (fd < 0) {
+	    std::cerr << cmdname << ": unable to open " << batch <<
+	       " for reading" << std::endl;
+	    std::exit(1);
+	 }
+	 EventReader traces(fd);
+	 if (!check_traces(process, traces, seed, threads)) std::exit(1);
+	 std::exit(0);
       }
-      if (opt_v) {
-	 std::cout << "Acceptable: " <<
-	    process->acceptable(status) << std::endl;
+      if (opt_R) {
+	 auto stats = random_runs(process, seed, event_count, runs, threads);
+	 print_statistics(stats);
+	 if (stats.failures > 0) std::exit(1);
+	 std::exit(0);
       }
+      auto status = make_accounted<Status>(seed);
+      /* output is flushed only when required for interactive use */
+      std::ios_base::sync_with_stdio(false);
+      TraceOutput output(std::cout, output_mode, opt_a, opt_e, opt_p, opt_v,
+	 !opt_P && isatty(0));
+      output.restrict_printing(print_depth, print_diff);
+      output.start(process, status);
       if (!process->accepts_success(status)) {
-	 std::string event;
+	 EventReader input(0);
+	 /* binary traces are accepted as well where
+	    the borders between traces are ignored;
+	    a terminal is not checked for them as this would
+	    block before the prompt has been flushed */
+	 std::unique_ptr<BinaryTraceReader> binary_input;
+	 if (!opt_P && !isatty(0) && BinaryTraceReader::is_binary(input)) {
+	    binary_input = std::make_unique<BinaryTraceReader>(input);
+	    if (!binary_input->read_header()) {
+	       std::cerr << cmdname << ": invalid binary trace" <<
+		  std::endl;
+	       std::exit(1);
+	    }
+	 }
+	 std::string_view event; // refers to input or chosen
+	 std::string chosen; // event chosen by -P
+	 std::string name; // reused to avoid allocations per event
 	 auto fetch_event = [&]() -> bool {
 	    if (opt_P) {
 	       if (event_count == 0) return false;
@@ -147,36 +933,80 @@ int main(int argc, char** argv) {
 	       auto acceptable = process->acceptable(status);
 	       if (acceptable.cardinality() == 0) return false;
 	       auto chose = status->draw(acceptable.cardinality());
-	       event = *std::next(acceptable.begin(), chose);
+	       chosen = *std::next(acceptable.begin(), chose);
+	       event = chosen;
 	       return true;
+	    } else if (binary_input) {
+	       for (;;) {
+		  switch (binary_input->next(event)) {
+		     case BinaryTraceReader::event:
+			return true;
+		     case BinaryTraceReader::end_of_trace:
+			break;
+		     case BinaryTraceReader::end:
+			return false;
+		     case BinaryTraceReader::error:
+			std::cerr << cmdname << ": corrupted binary trace" <<
+			   std::endl;
+			std::exit(1);
+		  }
+	       }
 	    } else {
-	       return !!(std::cin >> event);
+	       output.await_event();
+	       return input.next(event);
 	    }
 	 };
+	 /* previous states for undo which share their status
+	    with the run until it is about to be changed */
+	 struct State {
+	    ProcessPtr process;
+	    StatusPtr status;
+	    std::string event; // that led to the next state
+	 };
+	 std::vector<State> history;
+	 bool shared = false; // status is kept by history
 	 while (fetch_event()) {
+	    if (opt_u && !opt_P && event == "undo") {
+	       if (history.empty()) {
+		  output.nothing_to_undo();
+		  continue;
+	       }
+	       auto& state = history.back();
+	       process = state.process; status = state.status;
+	       history.pop_back();
+	       shared = false;
+	       output.undone(state.event, process, status);
+	       continue;
+	    }
 	    if (process->get_alphabet().is_member(event)) {
-	       std::tie(process, status) = process->proceed(event, status);
+	       name.assign(event);
+	       if (opt_u) {
+		  history.push_back({process, status, name});
+		  shared = true;
+	       }
+	       if (shared) {
+		  status = Status::clone(status);
+		  shared = false;
+	       }
+	       std::tie(process, status) = process->proceed(name, status);
 	       if (!process) {
-		  std::cerr << "cannot accept " << event << std::endl;
+		  output.refused(event);
+		  std::cerr << "cannot accept " << event;
+		  if (opt_P) {
+		     /* permit this run to be repeated */
+		     std::cerr << " (seed " << seed << ")";
+		  }
+		  std::cerr << std::endl;
 		  std::exit(1);
 	       }
 	       if (process->accepts_success(status)) break;
-	       if (opt_e) {
-		  std::cout << event << std::endl;
-	       }
-	       if (opt_p) {
-		  std::cout << "Process: " << process << std::endl;
-	       }
-	       if (opt_v) {
-		  std::cout << "Acceptable: " <<
-		     process->acceptable(status) << std::endl;
-	       }
+	       output.accepted(event, process, status);
 	    } else {
-	       std::cout << "Not in alphabet: " << event << std::endl;
+	       output.not_in_alphabet(event);
 	    }
 	 }
       }
-      std::cout << "OK" << std::endl;
+      output.ok();
    } else {
       std::exit(1);
    }
@@ -26,23 +26,85 @@
 #ifndef UNIFORM_INT_HPP
 #define UNIFORM_INT_HPP
 
+#include <bitset>
+#include <cstdint>
 #include <random>
 
 /* simple class for a pseudo-random generator producing
-   uniformely distributed integers */
+   uniformely distributed integers;
+   this is based on SplitMix64 which has a state of 64 bits only
+   and which permits to split off independent generators
+   (see Steele, Lea, and Flood: Fast splittable pseudorandom
+   number generators, OOPSLA 2014) */
 class UniformIntDistribution {
    public:
-      UniformIntDistribution() : engine(std::random_device()()) {}
-      /* return number in the range of [0..upper_limit) */
+      UniformIntDistribution() : state(random_seed()) {}
+      UniformIntDistribution(std::uint64_t seed) : state(seed) {}
+      UniformIntDistribution(std::uint64_t seed, std::uint64_t gamma) :
+	 state(seed), gamma(gamma) {
+      }
+      /* return number in the range of [0..upper_limit),
+	 see Lemire: Fast random integer generation in an interval,
+	 ACM TOMACS 29(1), 2019 */
       unsigned int draw(unsigned int upper_limit) {
-	 return std::uniform_int_distribution<unsigned int>
-	    (0, upper_limit-1)(engine);
+	 std::uint64_t m = std::uint64_t(next32()) * upper_limit;
+	 std::uint32_t low = m;
+	 if (low < upper_limit) {
+	    std::uint32_t threshold = -upper_limit % upper_limit;
+	    while (low < threshold) {
+	       m = std::uint64_t(next32()) * upper_limit;
+	       low = m;
+	    }
+	 }
+	 return m >> 32;
       }
       bool flip() {
 	 return draw(2);
       }
+      /* return a generator whose sequence is independent
+	 from that of this generator; it gets its own gamma
+	 as generators which share the gamma produce
+	 sequences which are merely shifted against each other */
+      UniformIntDistribution split() {
+	 std::uint64_t seed = next();
+	 return UniformIntDistribution(seed, mix_gamma(next_seed()));
+      }
+      /* seed which reproduces the sequence that is to be
+	 delivered next if used with the default gamma */
+      std::uint64_t get_seed() const {
+	 return state;
+      }
+      static std::uint64_t random_seed() {
+	 std::random_device rd;
+	 return std::uint64_t(rd()) << 32 | rd();
+      }
    private:
-      std::mt19937 engine;
+      std::uint64_t state;
+      std::uint64_t gamma = 0x9e3779b97f4a7c15;
+
+      std::uint64_t next_seed() {
+	 return state += gamma;
+      }
+      /* derive an odd gamma with sufficiently many bit transitions,
+	 see mixGamma of Steele et al. */
+      static std::uint64_t mix_gamma(std::uint64_t z) {
+	 z = (z ^ (z >> 33)) * 0xff51afd7ed558ccd;
+	 z = (z ^ (z >> 33)) * 0xc4ceb9fe1a85ec53;
+	 z = (z ^ (z >> 33)) | 1;
+	 if (std::bitset<64>(z ^ (z >> 1)).count() < 24) {
+	    z ^= 0xaaaaaaaaaaaaaaaa;
+	 }
+	 return z;
+      }
+      std::uint64_t next() {
+	 std::uint64_t z = next_seed();
+	 z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+	 z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+	 return z ^ (z >> 31);
+      }
+      std::uint32_t next32() {
+	 return next() >> 32;
+      }
 };
 
 #endif
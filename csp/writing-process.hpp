@@ -36,7 +36,6 @@
 #include <cassert>
 #include <iostream>
 #include <memory>
-#include <sstream>
 #include <string>
 
 #include "alphabet.hpp"
@@ -57,7 +56,9 @@ namespace CSP {
 	 }
 	 WritingProcess(ChannelPtr channel, ExpressionPtr expression,
 		  ProcessPtr process) :
-	       channel(channel), expression(expression), process(process) {
+	       channel(channel), expression(expression),
+	       code(std::make_unique<ExpressionCode>(expression)),
+	       process(process) {
 	    assert(process);
 	    assert(expression);
 	 }
@@ -70,14 +71,14 @@ namespace CSP {
 	    } else {
 	       out << channel->get_name() << "!" << varname << " -> ";
 	    }
-	    process->print(out);
+	    print_subterm(out, process);
 	 }
 	 void expanded_print(std::ostream& out) const override {
 	    /* add parentheses if we are at top-level,
 	       otherwise this is done by SelectingProcess */
 	    out << "("; print(out); out << ")";
 	 }
-	 Alphabet acceptable(StatusPtr status) const final {
+	 Alphabet internal_acceptable(StatusPtr status) const final {
 	    auto message = get_message(status);
 	    auto event = channel->get_name() + "." + message;
 	    return Alphabet(event);
@@ -87,13 +88,12 @@ namespace CSP {
 	 ChannelPtr channel;
 	 std::string varname;
 	 ExpressionPtr expression;
+	 std::unique_ptr<const ExpressionCode> code; // compiled expression
 	 ProcessPtr process;
 
 	 std::string get_message(StatusPtr status) const {
-	    if (expression) {
-	       auto val = expression->eval(status);
-	       std::ostringstream os; os << val;
-	       return os.str();
+	    if (code) {
+	       return std::to_string(code->eval(status));
 	    } else {
 	       return status->lookup<Identifier>(varname)->get_name();
 	    }